@@ -0,0 +1,614 @@
+// Micro-benchmarks for the emoji hot paths. Not built by default:
+//   cmake -B build -S . -DIMBORED_BUILD_BENCHMARKS=ON
+//   cmake --build build --target emoji_bench
+//   build/bin/emoji_bench [font.ttf ...]
+// Fonts are optional; glyph benchmarks run on each one given, e.g. Noto
+// Color Emoji (Noto-COLRv1.ttf) and Twemoji (Twemoji.Mozilla.ttf, COLR v0).
+// Every result is the best of several runs, so background noise only
+// ever makes a number look worse. Exits non-zero if a SIMD kernel
+// disagrees with the scalar reference.
+
+#include "ui/bitmap_resampler.hpp"
+#include "ui/codepoint_table.hpp"
+#include "ui/composite_kernels.hpp"
+#include "ui/emoji_manager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// FreeType headers
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_COLOR_H
+
+using namespace ImBored::UI;
+
+// Best wall time of `repeats` calls to fn, in nanoseconds per item
+template <typename Fn>
+static double TimePerItem(size_t items, int repeats, Fn&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best / static_cast<double>(items);
+}
+
+// Keeps results alive so the timed loops can't be optimized away
+static volatile uint64_t g_sink;
+
+// ---- Codepoint lookup ----
+
+// Emoji blocks a color font typically covers
+static std::vector<uint32_t> EmojiCodepoints() {
+    const uint32_t ranges[][2] = {
+        {0x2600, 0x27BF}, {0x1F300, 0x1F5FF}, {0x1F600, 0x1F64F},
+        {0x1F680, 0x1F6FF}, {0x1F900, 0x1F9FF}, {0x1FA70, 0x1FAFF},
+    };
+    std::vector<uint32_t> codepoints;
+    for (const auto& range : ranges) {
+        for (uint32_t cp = range[0]; cp <= range[1]; ++cp) {
+            codepoints.push_back(cp);
+        }
+    }
+    return codepoints;
+}
+
+// Chat-like text: mostly ASCII, some accented Latin and CJK, and an emoji
+// roughly every ten characters
+static std::vector<uint32_t> MixedText(const std::vector<uint32_t>& emoji, size_t length) {
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> kind(0, 99);
+    std::vector<uint32_t> text;
+    text.reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        int k = kind(random);
+        if (k < 78) {
+            text.push_back(k < 15 ? ' ' : 'a' + random() % 26);
+        } else if (k < 84) {
+            text.push_back(0xC0 + random() % 0x40);
+        } else if (k < 90) {
+            text.push_back(0x4E00 + random() % 0x5200);
+        } else {
+            text.push_back(emoji[random() % emoji.size()]);
+        }
+    }
+    return text;
+}
+
+// CodepointTable + contiguous records (EmojiManager today) against the
+// std::unordered_map<uint32_t, EmojiGlyph> it replaced
+static void BenchCodepointLookup() {
+    std::vector<uint32_t> emoji = EmojiCodepoints();
+    std::vector<uint32_t> text = MixedText(emoji, 1 << 20);
+    
+    std::unordered_map<uint32_t, EmojiGlyph> map;
+    std::vector<EmojiGlyph> glyphs;
+    CodepointTable table;
+    for (uint32_t cp : emoji) {
+        EmojiGlyph glyph = {};
+        glyph.codepoint = cp;
+        glyph.advance = static_cast<float>(cp & 31);
+        map[cp] = glyph;
+        table.insert(cp, static_cast<uint32_t>(glyphs.size()));
+        glyphs.push_back(glyph);
+    }
+    
+    double mapTime = TimePerItem(text.size(), 20, [&] {
+        uint64_t sum = 0;
+        for (uint32_t cp : text) {
+            auto it = map.find(cp);
+            const EmojiGlyph* glyph = it != map.end() ? &it->second : nullptr;
+            sum += glyph ? static_cast<uint64_t>(glyph->advance) : 1;
+        }
+        g_sink = sum;
+    });
+    
+    double tableTime = TimePerItem(text.size(), 20, [&] {
+        uint64_t sum = 0;
+        for (uint32_t cp : text) {
+            int index = table.find(cp);
+            const EmojiGlyph* glyph = index >= 0 ? &glyphs[index] : nullptr;
+            sum += glyph ? static_cast<uint64_t>(glyph->advance) : 1;
+        }
+        g_sink = sum;
+    });
+    
+    std::printf("codepoint lookup, %zu emoji, %zu mixed codepoints\n", emoji.size(), text.size());
+    std::printf("  unordered_map   %6.2f ns/codepoint\n", mapTime);
+    std::printf("  CodepointTable  %6.2f ns/codepoint  (%zu pages, %.1fx)\n", tableTime, table.getPageCount(),
+                mapTime / tableTime);
+}
+
+// ---- Compositing kernels ----
+
+// Random spans through every kernel set, compared byte for byte with the
+// scalar reference. Lengths and offsets cover the SIMD tails and
+// unaligned starts; coverage mixes zero runs, edges and solid interiors.
+static bool CheckCompositeKernels() {
+    std::vector<CompositeKernelSet> kernels = GetAvailableCompositeKernels();
+    const CompositeKernelSet& scalar = kernels.back();
+    std::mt19937 random(42);
+    
+    std::printf("kernel check against scalar\n");
+    if (kernels.size() == 1) {
+        std::printf("  no SIMD kernels in this build\n");
+        return true;
+    }
+    
+    const int SPANS = 20000;
+    const size_t MAX_PIXELS = 80;
+    std::vector<uint8_t> coverage(MAX_PIXELS + 4), src((MAX_PIXELS + 4) * 4);
+    std::vector<uint8_t> dst((MAX_PIXELS + 4) * 4), expected(dst.size()), actual(dst.size());
+    std::vector<std::vector<uint8_t>> rows(8, std::vector<uint8_t>((MAX_PIXELS + 4) * 4));
+    
+    bool allOk = true;
+    for (size_t k = 0; k + 1 < kernels.size(); ++k) {
+        const CompositeKernelSet& kernel = kernels[k];
+        const char* failed = nullptr;
+        
+        for (int n = 0; n < SPANS && !failed; ++n) {
+            size_t pixels = random() % MAX_PIXELS;
+            size_t offset = random() % 4;
+            
+            int shape = random() % 3;
+            for (uint8_t& c : coverage) {
+                uint8_t value = static_cast<uint8_t>(random());
+                c = shape == 0 ? value : shape == 1 ? (value < 128 ? 0 : 255) : (value < 96 ? 0 : value);
+            }
+            for (uint8_t& d : dst) {
+                d = static_cast<uint8_t>(random());
+            }
+            // Premultiplied sources never exceed their alpha
+            for (size_t i = 0; i < src.size(); i += 4) {
+                uint8_t a = static_cast<uint8_t>(random());
+                for (int c = 0; c < 3; ++c) {
+                    src[i + c] = static_cast<uint8_t>(random() % (a + 1u));
+                }
+                src[i + 3] = a;
+            }
+            uint8_t color[4];
+            for (uint8_t& c : color) {
+                c = static_cast<uint8_t>(random());
+            }
+            
+            expected = dst;
+            actual = dst;
+            scalar.composite(expected.data() + offset * 4, coverage.data() + offset, pixels, color);
+            kernel.composite(actual.data() + offset * 4, coverage.data() + offset, pixels, color);
+            if (actual != expected) {
+                failed = "composite";
+                break;
+            }
+            
+            expected = dst;
+            actual = dst;
+            scalar.srcOver(expected.data() + offset * 4, src.data() + offset * 4, coverage.data() + offset, pixels);
+            kernel.srcOver(actual.data() + offset * 4, src.data() + offset * 4, coverage.data() + offset, pixels);
+            if (actual != expected) {
+                failed = "srcOver";
+                break;
+            }
+            
+            // Weights in 1/256ths summing to 256, as the resampler builds them
+            size_t rowCount = 1 + random() % rows.size();
+            uint16_t weights[8];
+            uint32_t left = 256;
+            const uint8_t* rowPointers[8];
+            for (size_t r = 0; r < rowCount; ++r) {
+                weights[r] = static_cast<uint16_t>(r + 1 == rowCount ? left : random() % (left + 1));
+                left -= weights[r];
+                for (uint8_t& b : rows[r]) {
+                    b = static_cast<uint8_t>(random());
+                }
+                rowPointers[r] = rows[r].data() + offset;
+            }
+            scalar.filterRows(expected.data(), rowPointers, weights, rowCount, pixels * 4);
+            kernel.filterRows(actual.data(), rowPointers, weights, rowCount, pixels * 4);
+            if (!std::equal(expected.begin(), expected.begin() + pixels * 4, actual.begin())) {
+                failed = "filterRows";
+            }
+        }
+        
+        if (failed) {
+            std::printf("  %-6s %s differs from scalar\n", kernel.name, failed);
+            allOk = false;
+        } else {
+            std::printf("  %-6s ok (%d random spans per kernel)\n", kernel.name, SPANS);
+        }
+    }
+    return allOk;
+}
+
+// One color layer of a glyph: its coverage box in the cell and its color
+struct BenchLayer {
+    std::vector<uint8_t> coverage;
+    int left, top, width, height;
+    uint8_t color[4];
+};
+
+// A COLRv1 paint graph's PaintGlyph leaves, in drawing order, with their
+// solid colors (gradients count as gray). Transforms are ignored: they
+// move masks around but barely change how many pixels get composited.
+static void CollectPaintGlyphs(FT_Face face, FT_OpaquePaint opaque, int depth,
+                               std::vector<std::pair<FT_UInt, FT_ColorIndex>>& leaves) {
+    FT_COLR_Paint paint;
+    if (depth > 16 || !FT_Get_Paint(face, opaque, &paint)) {
+        return;
+    }
+    
+    switch (paint.format) {
+        case FT_COLR_PAINTFORMAT_COLR_LAYERS: {
+            FT_LayerIterator iterator = paint.u.colr_layers.layer_iterator;
+            FT_OpaquePaint layer;
+            while (FT_Get_Paint_Layers(face, &iterator, &layer)) {
+                CollectPaintGlyphs(face, layer, depth + 1, leaves);
+            }
+            break;
+        }
+        case FT_COLR_PAINTFORMAT_GLYPH: {
+            FT_COLR_Paint fill;
+            FT_ColorIndex color = {0xFFFE, 1 << 14};
+            if (FT_Get_Paint(face, paint.u.glyph.paint, &fill) && fill.format == FT_COLR_PAINTFORMAT_SOLID) {
+                color = fill.u.solid.color;
+            }
+            leaves.push_back({paint.u.glyph.glyphID, color});
+            break;
+        }
+        case FT_COLR_PAINTFORMAT_COLR_GLYPH: {
+            FT_OpaquePaint root;
+            root.p = nullptr;
+            if (FT_Get_Color_Glyph_Paint(face, paint.u.colr_glyph.glyphID, FT_COLOR_NO_ROOT_TRANSFORM, &root)) {
+                CollectPaintGlyphs(face, root, depth + 1, leaves);
+            }
+            break;
+        }
+        case FT_COLR_PAINTFORMAT_TRANSFORM:
+            CollectPaintGlyphs(face, paint.u.transform.paint, depth + 1, leaves);
+            break;
+        case FT_COLR_PAINTFORMAT_TRANSLATE:
+            CollectPaintGlyphs(face, paint.u.translate.paint, depth + 1, leaves);
+            break;
+        case FT_COLR_PAINTFORMAT_SCALE:
+            CollectPaintGlyphs(face, paint.u.scale.paint, depth + 1, leaves);
+            break;
+        case FT_COLR_PAINTFORMAT_ROTATE:
+            CollectPaintGlyphs(face, paint.u.rotate.paint, depth + 1, leaves);
+            break;
+        case FT_COLR_PAINTFORMAT_SKEW:
+            CollectPaintGlyphs(face, paint.u.skew.paint, depth + 1, leaves);
+            break;
+        case FT_COLR_PAINTFORMAT_COMPOSITE:
+            CollectPaintGlyphs(face, paint.u.composite.backdrop_paint, depth + 1, leaves);
+            CollectPaintGlyphs(face, paint.u.composite.source_paint, depth + 1, leaves);
+            break;
+        default:
+            break;
+    }
+}
+
+// Color layers of every color glyph in the font (COLR v0 layers, or the
+// PaintGlyph masks of COLRv1), rasterized once at pixelSize
+static std::vector<std::vector<BenchLayer>> LoadLayeredGlyphs(FT_Face face, int pixelSize, size_t maxGlyphs) {
+    std::vector<std::vector<BenchLayer>> glyphs;
+    if (!FT_IS_SCALABLE(face) || FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(pixelSize))) {
+        return glyphs;
+    }
+    
+    FT_Palette_Data paletteData;
+    FT_Color* palette = nullptr;
+    if (FT_Palette_Data_Get(face, &paletteData) || FT_Palette_Select(face, 0, &palette)) {
+        paletteData.num_palette_entries = 0;
+    }
+    
+    FT_UInt glyphIndex;
+    for (FT_ULong cp = FT_Get_First_Char(face, &glyphIndex); glyphIndex != 0 && glyphs.size() < maxGlyphs;
+         cp = FT_Get_Next_Char(face, cp, &glyphIndex)) {
+        std::vector<std::pair<FT_UInt, FT_ColorIndex>> leaves;
+        FT_LayerIterator iterator;
+        iterator.p = nullptr;
+        FT_UInt layerGlyph, colorIndex;
+        while (FT_Get_Color_Glyph_Layer(face, glyphIndex, &layerGlyph, &colorIndex, &iterator)) {
+            leaves.push_back({layerGlyph, {static_cast<FT_UInt16>(colorIndex), 1 << 14}});
+        }
+        FT_OpaquePaint root;
+        root.p = nullptr;
+        if (leaves.empty() && FT_Get_Color_Glyph_Paint(face, glyphIndex, FT_COLOR_NO_ROOT_TRANSFORM, &root)) {
+            CollectPaintGlyphs(face, root, 0, leaves);
+        }
+        
+        std::vector<BenchLayer> layers;
+        for (const auto& leaf : leaves) {
+            if (FT_Load_Glyph(face, leaf.first, FT_LOAD_DEFAULT) || FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL)) {
+                continue;
+            }
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            if (bitmap.pixel_mode != FT_PIXEL_MODE_GRAY || bitmap.width == 0 || bitmap.rows == 0) {
+                continue;
+            }
+            
+            BenchLayer layer;
+            layer.left = face->glyph->bitmap_left;
+            layer.top = pixelSize - face->glyph->bitmap_top;
+            layer.width = static_cast<int>(bitmap.width);
+            layer.height = static_cast<int>(bitmap.rows);
+            for (int row = 0; row < layer.height; ++row) {
+                const uint8_t* src = bitmap.buffer + row * bitmap.pitch;
+                layer.coverage.insert(layer.coverage.end(), src, src + layer.width);
+            }
+            
+            // 0xFFFF is the text color, 0xFFFE the bench's gradient gray
+            uint16_t index = leaf.second.palette_index;
+            if (palette && index < paletteData.num_palette_entries) {
+                const FT_Color& c = palette[index];
+                layer.color[0] = c.red;
+                layer.color[1] = c.green;
+                layer.color[2] = c.blue;
+                layer.color[3] = static_cast<uint8_t>(c.alpha * leaf.second.alpha / (1 << 14));
+            } else {
+                uint8_t gray = index == 0xFFFE ? 128 : 0;
+                layer.color[0] = layer.color[1] = layer.color[2] = gray;
+                layer.color[3] = 255;
+            }
+            layers.push_back(std::move(layer));
+        }
+        if (!layers.empty()) {
+            glyphs.push_back(std::move(layers));
+        }
+    }
+    return glyphs;
+}
+
+// Composite every layer into a pixelSize cell the way
+// COLRv1Renderer::compositeLayer does, clipping each layer's box
+static void CompositeGlyph(CompositeSpanFn composite, const std::vector<BenchLayer>& layers, uint8_t* cell,
+                           int pixelSize) {
+    for (const BenchLayer& layer : layers) {
+        int colStart = std::max(0, -layer.left);
+        int colEnd = std::min(layer.width, pixelSize - layer.left);
+        int rowStart = std::max(0, -layer.top);
+        int rowEnd = std::min(layer.height, pixelSize - layer.top);
+        if (colStart >= colEnd || rowStart >= rowEnd) {
+            continue;
+        }
+        for (int row = rowStart; row < rowEnd; ++row) {
+            uint8_t* dst = cell + (static_cast<size_t>(layer.top + row) * pixelSize + layer.left + colStart) * 4;
+            composite(dst, layer.coverage.data() + row * layer.width + colStart, static_cast<size_t>(colEnd - colStart),
+                      layer.color);
+        }
+    }
+}
+
+// Per-glyph compositing time of real color glyphs, scalar reference
+// against the kernel the renderer dispatches to
+static void BenchCompositing(FT_Library library, const char* path, int pixelSize) {
+    FT_Face face;
+    if (FT_New_Face(library, path, 0, &face)) {
+        std::printf("compositing: cannot open %s\n", path);
+        return;
+    }
+    
+    std::vector<std::vector<BenchLayer>> glyphs = LoadLayeredGlyphs(face, pixelSize, 1000);
+    FT_Done_Face(face);
+    if (glyphs.empty()) {
+        std::printf("compositing, %s: no COLR layers to composite\n", path);
+        return;
+    }
+    
+    size_t layerCount = 0;
+    for (const auto& layers : glyphs) {
+        layerCount += layers.size();
+    }
+    
+    std::vector<uint8_t> cell(static_cast<size_t>(pixelSize) * pixelSize * 4);
+    auto timeKernel = [&](CompositeSpanFn composite) {
+        return TimePerItem(glyphs.size(), 10, [&] {
+            for (const auto& layers : glyphs) {
+                std::fill(cell.begin(), cell.end(), 0);
+                CompositeGlyph(composite, layers, cell.data(), pixelSize);
+            }
+            g_sink = cell[cell.size() / 2];
+        });
+    };
+    
+    double scalarTime = timeKernel(CompositeSpanScalar);
+    double kernelTime = timeKernel(GetCompositeSpanKernel());
+    
+    std::printf("compositing, %s: %zu glyphs at %d px, %.1f layers/glyph\n", path, glyphs.size(), pixelSize,
+                static_cast<double>(layerCount) / glyphs.size());
+    std::printf("  scalar          %8.0f ns/glyph\n", scalarTime);
+    std::printf("  %-14s  %8.0f ns/glyph  (%.1fx)\n", GetCompositeSpanKernelName(), kernelTime,
+                scalarTime / kernelTime);
+}
+
+// ---- Strike downscaling ----
+
+struct BenchBitmap {
+    std::vector<uint8_t> pixels;    // Premultiplied, 4 bytes per pixel, tightly packed
+    int width, height;
+};
+
+// The largest color strike of every glyph in a bitmap font (CBDT/sbix)
+static std::vector<BenchBitmap> LoadStrikeGlyphs(FT_Library library, const char* path, size_t maxGlyphs) {
+    std::vector<BenchBitmap> glyphs;
+    FT_Face face;
+    if (FT_New_Face(library, path, 0, &face)) {
+        return glyphs;
+    }
+    
+    if (FT_HAS_COLOR(face) && face->num_fixed_sizes > 0) {
+        int largest = 0;
+        for (int i = 1; i < face->num_fixed_sizes; ++i) {
+            if (face->available_sizes[i].height > face->available_sizes[largest].height) {
+                largest = i;
+            }
+        }
+        FT_Select_Size(face, largest);
+        
+        FT_UInt glyphIndex;
+        for (FT_ULong cp = FT_Get_First_Char(face, &glyphIndex); glyphIndex != 0 && glyphs.size() < maxGlyphs;
+             cp = FT_Get_Next_Char(face, cp, &glyphIndex)) {
+            if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_COLOR)) {
+                continue;
+            }
+            const FT_Bitmap& bitmap = face->glyph->bitmap;
+            if (bitmap.pixel_mode != FT_PIXEL_MODE_BGRA || bitmap.width == 0 || bitmap.rows == 0) {
+                continue;
+            }
+            
+            BenchBitmap glyph;
+            glyph.width = static_cast<int>(bitmap.width);
+            glyph.height = static_cast<int>(bitmap.rows);
+            for (int row = 0; row < glyph.height; ++row) {
+                const uint8_t* src = bitmap.buffer + row * bitmap.pitch;
+                glyph.pixels.insert(glyph.pixels.end(), src, src + glyph.width * 4);
+            }
+            glyphs.push_back(std::move(glyph));
+        }
+    }
+    
+    FT_Done_Face(face);
+    return glyphs;
+}
+
+// Stand-ins for Noto Color Emoji's 136x128 strike: overlapping
+// antialiased discs, so there are flat areas, edges and transparency
+static std::vector<BenchBitmap> SyntheticStrikes(size_t count) {
+    std::mt19937 random(7);
+    std::vector<BenchBitmap> glyphs(count);
+    for (BenchBitmap& glyph : glyphs) {
+        glyph.width = 136;
+        glyph.height = 128;
+        glyph.pixels.assign(static_cast<size_t>(glyph.width) * glyph.height * 4, 0);
+        for (int disc = 0; disc < 4; ++disc) {
+            float cx = static_cast<float>(random() % glyph.width);
+            float cy = static_cast<float>(random() % glyph.height);
+            float radius = 10.0f + random() % 50;
+            uint8_t color[3] = {static_cast<uint8_t>(random()), static_cast<uint8_t>(random()),
+                                static_cast<uint8_t>(random())};
+            for (int y = 0; y < glyph.height; ++y) {
+                for (int x = 0; x < glyph.width; ++x) {
+                    float d = std::sqrt((x - cx) * (x - cx) + (y - cy) * (y - cy));
+                    float a = std::clamp(radius - d, 0.0f, 1.0f);
+                    uint8_t* p = &glyph.pixels[(static_cast<size_t>(y) * glyph.width + x) * 4];
+                    for (int c = 0; c < 3; ++c) {
+                        p[c] = static_cast<uint8_t>(color[c] * a + p[c] * (1.0f - a) + 0.5f);
+                    }
+                    p[3] = static_cast<uint8_t>(255 * a + p[3] * (1.0f - a) + 0.5f);
+                }
+            }
+        }
+    }
+    return glyphs;
+}
+
+// The same area-weighted box filter written the obvious way: a 2D loop in
+// floating point per output pixel
+static void DownscaleNaive(const BenchBitmap& src, uint8_t* dst, int dstWidth, int dstHeight) {
+    double ratioX = static_cast<double>(src.width) / dstWidth;
+    double ratioY = static_cast<double>(src.height) / dstHeight;
+    for (int y = 0; y < dstHeight; ++y) {
+        double y0 = y * ratioY, y1 = std::min<double>(src.height, (y + 1) * ratioY);
+        for (int x = 0; x < dstWidth; ++x) {
+            double x0 = x * ratioX, x1 = std::min<double>(src.width, (x + 1) * ratioX);
+            double sum[4] = {0, 0, 0, 0};
+            for (int sy = static_cast<int>(y0); sy < std::ceil(y1); ++sy) {
+                double wy = std::min<double>(y1, sy + 1) - std::max<double>(y0, sy);
+                for (int sx = static_cast<int>(x0); sx < std::ceil(x1); ++sx) {
+                    double w = wy * (std::min<double>(x1, sx + 1) - std::max<double>(x0, sx));
+                    const uint8_t* p = &src.pixels[(static_cast<size_t>(sy) * src.width + sx) * 4];
+                    for (int c = 0; c < 4; ++c) {
+                        sum[c] += p[c] * w;
+                    }
+                }
+            }
+            for (int c = 0; c < 4; ++c) {
+                dst[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] =
+                    static_cast<uint8_t>(std::lround(sum[c] / (ratioX * ratioY)));
+            }
+        }
+    }
+}
+
+// Strike -> atlas downscale per glyph at the sizes the atlas uses, against
+// the naive filter; also reports the largest channel difference between them
+static void BenchDownscale(const std::vector<BenchBitmap>& glyphs, const char* label) {
+    if (glyphs.empty()) {
+        return;
+    }
+    std::printf("downscale, %s: %zu glyphs, first %dx%d, %s kernel\n", label, glyphs.size(), glyphs[0].width,
+                glyphs[0].height, GetCompositeSpanKernelName());
+    
+    BitmapResampler resampler;
+    std::vector<uint8_t> expected, actual;
+    for (int size : {18, 24, 32, 48}) {
+        // Fit the strike in a size x size cell, keeping its aspect ratio
+        auto dstSize = [&](const BenchBitmap& glyph, int& width, int& height) {
+            int longest = std::max(glyph.width, glyph.height);
+            width = std::max(1, glyph.width * size / longest);
+            height = std::max(1, glyph.height * size / longest);
+        };
+        
+        int maxDiff = 0;
+        for (const BenchBitmap& glyph : glyphs) {
+            int width, height;
+            dstSize(glyph, width, height);
+            expected.resize(static_cast<size_t>(width) * height * 4);
+            actual.resize(expected.size());
+            DownscaleNaive(glyph, expected.data(), width, height);
+            resampler.downscale(glyph.pixels.data(), glyph.width, glyph.height, glyph.width * 4, actual.data(),
+                                width, height);
+            for (size_t i = 0; i < expected.size(); ++i) {
+                maxDiff = std::max(maxDiff, std::abs(expected[i] - actual[i]));
+            }
+        }
+        
+        actual.resize(static_cast<size_t>(size) * size * 4);
+        double naiveTime = TimePerItem(glyphs.size(), 5, [&] {
+            for (const BenchBitmap& glyph : glyphs) {
+                int width, height;
+                dstSize(glyph, width, height);
+                DownscaleNaive(glyph, actual.data(), width, height);
+            }
+            g_sink = actual[0];
+        });
+        double resamplerTime = TimePerItem(glyphs.size(), 5, [&] {
+            for (const BenchBitmap& glyph : glyphs) {
+                int width, height;
+                dstSize(glyph, width, height);
+                resampler.downscale(glyph.pixels.data(), glyph.width, glyph.height, glyph.width * 4, actual.data(),
+                                    width, height);
+            }
+            g_sink = actual[0];
+        });
+        
+        std::printf("  %2d px  naive %7.1f us/glyph  BitmapResampler %6.1f us/glyph  (%.1fx, max diff %d)\n", size,
+                    naiveTime / 1000.0, resamplerTime / 1000.0, naiveTime / resamplerTime, maxDiff);
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchCodepointLookup();
+    bool kernelsOk = CheckCompositeKernels();
+    
+    BenchDownscale(SyntheticStrikes(64), "synthetic 136x128 strikes");
+    
+    FT_Library library;
+    if (argc > 1 && FT_Init_FreeType(&library) == 0) {
+        for (int i = 1; i < argc; ++i) {
+            BenchCompositing(library, argv[i], 64);
+            BenchDownscale(LoadStrikeGlyphs(library, argv[i], 300), argv[i]);
+        }
+        FT_Done_FreeType(library);
+    }
+    
+    return kernelsOk ? 0 : 1;
+}
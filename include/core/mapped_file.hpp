@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ImBored::Core {
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Map the file at path, replacing any previous mapping
+    bool open(const std::string& path);
+    void close();
+    
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    
+#ifdef _WIN32
+    void* m_file;     // HANDLE
+    void* m_mapping;  // HANDLE
+#endif
+};
+
+} // namespace ImBored::Core
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ImBored::UI {
+
+// Box-filter downscaler for premultiplied 4-channel bitmaps such as color
+// emoji strikes. Every output pixel averages the source area it covers,
+// weighting partly covered pixels by their overlap. Separable: the rows
+// are filtered, transposed and filtered again, so both passes run the
+// SIMD row kernel from composite_kernels. Filter taps and scratch buffers
+// are kept between calls; not thread-safe.
+class BitmapResampler {
+public:
+    BitmapResampler();
+    
+    // Scale src (srcPitch bytes per row) to dstWidth x dstHeight pixels,
+    // written tightly packed to dst. Sizes may only shrink.
+    void downscale(const uint8_t* src, int srcWidth, int srcHeight, int srcPitch,
+                   uint8_t* dst, int dstWidth, int dstHeight);
+                   
+private:
+    // Source range and weights (1/256ths, summing to 256) of each output
+    // pixel along one axis
+    struct Tap {
+        uint32_t first;
+        uint32_t count;
+        uint32_t weights;   // Offset into Taps::weights
+    };
+    
+    struct Taps {
+        int srcSize;
+        int dstSize;
+        std::vector<Tap> taps;
+        std::vector<uint16_t> weights;
+    };
+    
+    static void buildTaps(Taps& taps, int srcSize, int dstSize);
+    
+    // Filter srcCount rows of rowBytes each into taps.dstSize rows
+    void filterRows(const Taps& taps, const uint8_t* src, size_t srcPitch, size_t rowBytes, uint8_t* dst);
+    
+    // Swap the axes of a width x height bitmap of 4-byte pixels
+    static void transpose(const uint8_t* src, int width, int height, size_t srcPitch, uint8_t* dst);
+    
+    Taps m_rowTaps;
+    Taps m_columnTaps;
+    std::vector<const uint8_t*> m_rowPointers;
+    std::vector<uint8_t> m_filtered;        // Rows filtered, source width
+    std::vector<uint8_t> m_transposed;      // The same, transposed
+    std::vector<uint8_t> m_columns;         // Columns filtered, still transposed
+};
+
+} // namespace ImBored::UI
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ImBored::UI {
+
+// Two-level codepoint -> index map. The top level is indexed by
+// codepoint >> 8 and points at dense 256-entry pages; page 0 is all
+// empty, so a lookup is always two loads with no hashing or branches
+// on page presence. Entries store index + 1, 0 means "not present".
+class CodepointTable {
+public:
+    static constexpr uint32_t MAX_CODEPOINT = 0x110000;
+    
+    CodepointTable();
+    
+    void clear();
+    
+    // Map codepoint to index (index < 65535)
+    void insert(uint32_t codepoint, uint32_t index);
+    
+    // Index for codepoint, or -1
+    int find(uint32_t codepoint) const {
+        if (codepoint >= MAX_CODEPOINT) {
+            return -1;
+        }
+        uint32_t page = m_pageIndex[codepoint >> 8];
+        return static_cast<int>(m_entries[(page << 8) | (codepoint & 0xFF)]) - 1;
+    }
+    
+    // Pages in use, not counting the shared empty page
+    size_t getPageCount() const { return m_entries.size() / 256 - 1; }
+    
+private:
+    std::vector<uint16_t> m_pageIndex;
+    std::vector<uint16_t> m_entries;
+};
+
+} // namespace ImBored::UI
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ImBored::UI {
+
+struct PaintDisplayList;
+
+// CPU rasterizer for COLRv1 paint graphs, for builds without Skia. Replays
+// a glyph's compiled PaintDisplayList: solid fills, linear, radial and
+// sweep gradients, affine transforms, glyph clips and every composite mode.
+// Lists come from PaintDisplayListCache, so rendering a glyph again at
+// another size does not touch the COLR table.
+// Layers and clip masks are kept between glyphs, so steady-state rendering
+// does not allocate. Not thread-safe: use one rasterizer per thread.
+class ColrPaintRasterizer {
+public:
+    ColrPaintRasterizer(int width, int height);
+    
+    // Draw glyphIndex into rgba (height rows of width pixels, `stride` bytes
+    // apart, straight alpha), with the em scaled to `scale` pixels per font
+    // unit and the baseline `baseline` pixels down from the top. Returns
+    // false if the glyph has no COLRv1 paint graph.
+    bool render(void* ftFace, uint32_t glyphIndex, float scale, float baseline, uint8_t* rgba, size_t stride);
+    
+private:
+    // Half-open pixel rectangle
+    struct Rect {
+        int x0, y0, x1, y1;
+        bool empty() const { return x0 >= x1 || y0 >= y1; }
+        Rect intersect(const Rect& other) const;
+        Rect unite(const Rect& other) const;
+    };
+    
+    // x' = xx * x + xy * y + dx, y' = yx * x + yy * y + dy
+    struct Affine {
+        float xx, xy, dx;
+        float yx, yy, dy;
+        
+        // This transform applied after `inner`
+        Affine concat(const Affine& inner) const;
+        bool invert(Affine& inverse) const;
+    };
+    
+    // Premultiplied RGBA surface; pixels outside `dirty` are transparent
+    struct Layer {
+        std::vector<uint8_t> pixels;
+        Rect dirty;
+    };
+    
+    // Coverage of the clip glyphs so far; only `bounds` is meaningful
+    struct Mask {
+        std::vector<uint8_t> coverage;
+        Rect bounds;
+    };
+    
+    struct PaintState {
+        Affine transform;   // Paint space (font units, y up) to canvas pixels
+        int mask;           // Index into m_masks, -1 when unclipped
+        Rect clip;          // Nothing is drawn outside this
+    };
+    
+    // Draw the list's ops [begin, end) onto the layer
+    bool drawOps(const PaintDisplayList& list, uint32_t begin, uint32_t end, const PaintState& state, int layer);
+    
+    // Fill the state's clip with one of the list's solid or gradient fills
+    bool fillPaint(const PaintDisplayList& list, uint32_t fill, const PaintState& state, int layer);
+    
+    // Draw `source` onto `backdrop` with an FT_Composite_Mode
+    void compositeLayers(int source, int backdrop, int mode);
+    
+    // Draw a layer over another, source over
+    void drawLayer(int source, int target);
+    
+    // Rasterize one of the list's outlines into a new mask intersected with
+    // the state's clip. Returns false when nothing of it is visible.
+    bool rasterizeClip(const PaintDisplayList& list, uint32_t outline, const PaintState& state, int mask);
+    
+    // Build m_gradient from a fill's sorted color stops
+    void buildGradient(const PaintDisplayList& list, uint32_t fill, float& tMin, float& tMax);
+    
+    int acquireLayer();
+    int acquireMask();
+    
+    int m_width;
+    int m_height;
+    
+    void* m_library;        // FT_Library of the current glyph's face
+    
+    // Stacks; entries past the counts are free for reuse
+    std::vector<Layer> m_layers;
+    std::vector<Mask> m_masks;
+    int m_layerCount;
+    int m_maskCount;
+    
+    std::vector<uint8_t> m_span;            // One row of source pixels
+    std::vector<uint8_t> m_fullCoverage;    // One row of 255s
+    std::vector<uint8_t> m_gradient;        // 256 premultiplied RGBA stops
+    std::vector<long> m_outlinePoints;      // FT_Vector pairs of the clip being rasterized
+};
+
+} // namespace ImBored::UI
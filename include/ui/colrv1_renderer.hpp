@@ -1,7 +1,11 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <string>
+#include <span>
 #include <cstdint>
+#include <cstddef>
 
 // Check if Skia is available and include headers
 #ifdef SKIA_AVAILABLE
@@ -11,51 +15,172 @@
 
 namespace ImBored::UI {
 
+class SvgDocumentCache;
+class GlyphCache;
+class ColrPaintRasterizer;
+class BitmapResampler;
+struct CachedGlyphBitmap;
+
+// Color glyph technologies a font carries, as bits
+enum ColorFormat : uint32_t {
+    COLOR_FORMAT_CBDT = 1u << 0,    // CBDT/CBLC bitmap strikes
+    COLOR_FORMAT_SBIX = 1u << 1,    // Apple sbix bitmap strikes
+    COLOR_FORMAT_COLR_V0 = 1u << 2, // COLR layers with CPAL colors
+    COLOR_FORMAT_COLR_V1 = 1u << 3, // COLR paint graphs
+    COLOR_FORMAT_SVG = 1u << 4,     // OT-SVG documents
+};
+
+// RGBA pixels with rows `stride` bytes apart, such as a slab of glyph cells
+struct AtlasView {
+    uint8_t* pixels;
+    int width;
+    int height;
+    size_t stride;
+};
+
+// One glyph of a renderGlyphs() batch, drawn into the renderer-sized cell
+// whose top-left corner is (x, y) in the view
+struct GlyphRequest {
+    uint32_t glyphIndex;
+    int x, y;
+    bool rendered;      // Set by renderGlyphs()
+};
+
 // COLRv1 paint renderer with optional Skia integration
-// Falls back to basic rendering when Skia is not available
+// Falls back to the built-in paint rasterizer when Skia is not available.
+// The face's color formats are probed the first time it is rendered, and
+// glyphs only go through the rasterizers for formats the font has.
 class COLRv1Renderer {
 public:
     COLRv1Renderer(int width, int height);
     ~COLRv1Renderer();
     
     // Render a COLRv1 glyph to the internal buffer
-    bool renderGlyph(void* ftFace, uint32_t glyphIndex, uint32_t codepoint);
+    bool renderGlyph(void* ftFace, uint32_t glyphIndex);
+    
+    // Render a batch of glyphs straight into their cells of `view`, in
+    // glyph order rather than request order. Requests whose cell doesn't
+    // fit the view are not rendered. Returns the number rendered.
+    size_t renderGlyphs(void* ftFace, std::span<GlyphRequest> requests, const AtlasView& view);
     
     // Get the rendered buffer
     const std::vector<uint8_t>& getBuffer() const { return m_buffer; }
     
-    // Clear the buffer
+    // Clear the buffer (the current cell during renderGlyphs)
     void clear();
     
+    // Parsed OT-SVG documents for the face being rendered (nullptr to skip
+    // SVG glyphs). Not owned; must only be used from this renderer's thread.
+    void setSvgDocuments(SvgDocumentCache* documents) { m_svgDocuments = documents; m_face = nullptr; }
+    
+    // Cache that layer and strike glyphs are loaded through (nullptr loads
+    // them straight from the face). face is the cache's id for the font
+    // passed to renderGlyph; same thread rules as above.
+    void setGlyphCache(GlyphCache* cache, int face) { m_glyphCache = cache; m_glyphCacheFace = face; }
+    
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
     
     // Check if Skia rendering is available
     static bool isSkiaAvailable();
     
+    // Identifies the rasterizer output; changes whenever glyphs would render
+    // differently so persisted atlases can be invalidated
+    static uint32_t getRenderVersion();
+    
+    // ColorFormat bits for a face, read from its table directory
+    static uint32_t detectColorFormats(void* ftFace);
+    
+    // Space-separated format names, for logs
+    static std::string describeColorFormats(uint32_t formats);
+    
 private:
     int m_width;
     int m_height;
     std::vector<uint8_t> m_buffer; // RGBA buffer
+    std::vector<uint8_t> m_scratch; // One row of coverage, sized once
+    SvgDocumentCache* m_svgDocuments;
+    GlyphCache* m_glyphCache;
+    int m_glyphCacheFace;
+    std::unique_ptr<ColrPaintRasterizer> m_paintRasterizer;
+    std::unique_ptr<BitmapResampler> m_resampler;
+    std::vector<uint8_t> m_strike; // Strike bitmap scaled to fit the buffer
+    
+    // Where the rasterizers draw: m_buffer, or a cell of the view during
+    // renderGlyphs
+    uint8_t* m_target;
+    size_t m_targetStride;
+    std::vector<uint32_t> m_order; // renderGlyphs request order, reused
+    
+    // Rasterizers for the current face, most specific first; each returns
+    // false when the glyph isn't in its format
+    using RenderFn = bool (COLRv1Renderer::*)(void* ftFace, uint32_t glyphIndex);
+    static constexpr int MAX_RENDER_PATHS = 6;
+    const void* m_face;             // FT_Face the table was built for
+    RenderFn m_renderPaths[MAX_RENDER_PATHS];
+    int m_renderPathCount;
+    
+    // Palette 0 of the current face, selected once
+    const void* m_palette;          // FT_Color*
+    uint16_t m_paletteSize;
     
 #ifdef SKIA_AVAILABLE
-    // Skia-specific members
-    SkSurface* m_surface;
+    // Raster surface drawing straight into m_buffer, created once; copied
+    // to the target when that is a batch cell
+    sk_sp<SkSurface> m_surface;
     SkCanvas* m_canvas;
     
-    // Render using Skia
-    bool renderWithSkia(void* ftFace, uint32_t glyphIndex, uint32_t codepoint);
+    // Render a COLRv1 glyph using Skia
+    bool renderWithSkia(void* ftFace, uint32_t glyphIndex);
 #endif
     
+    // Probe a new face's formats and palette and fill m_renderPaths
+    void selectRenderPaths(void* ftFace);
+    
+    // Clear the target and run the face's render paths into it
+    bool renderTarget(void* ftFace, uint32_t glyphIndex);
+    
+    uint8_t* getTargetRow(int y) const { return m_target + static_cast<size_t>(y) * m_targetStride; }
+    
+    // Load a glyph at the face's current size, through the glyph cache when
+    // there is one. Bitmaps come back in `bitmap`; outlines come back
+    // unrendered through `outline` (an FT_Outline valid until the next
+    // load), or are skipped when outline is null.
+    bool loadGlyph(void* ftFace, uint32_t glyphIndex, int32_t loadFlags, CachedGlyphBitmap& bitmap,
+                   void** outline = nullptr);
+    
     // Fallback rendering without Skia
-    // Helper to composite layers
-    void compositeLayer(const std::vector<uint8_t>& layer, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+    // Composite a color through a glyph's coverage bitmap, touching only
+    // the part of the buffer the bitmap covers
+    bool compositeLayer(const CachedGlyphBitmap& bitmap, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+    
+    // Rasterize an FT_Outline with FreeType's gray raster straight into the
+    // target, blending each coverage span with the color as it comes out.
+    // The outline is moved while rendering and restored.
+    bool compositeOutline(void* ftFace, void* ftOutline, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
     
     // Render a single paint layer (fallback)
     bool renderPaintLayer(void* ftFace, uint32_t glyphIndex, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& a);
     
-    // Render PNG/CBDT bitmap strikes (embedded color bitmaps)
-    bool renderBitmapStrike(void* ftFace, uint32_t glyphIndex, uint32_t codepoint);
+    // Font units to buffer pixels shared by the outline-based paths: pixels
+    // per unit and the baseline's distance from the top
+    bool getEmPlacement(void* ftFace, float& scale, float& baseline) const;
+    
+    // Render a COLRv1 paint graph with the built-in rasterizer
+    bool renderPaintGraph(void* ftFace, uint32_t glyphIndex);
+    
+    // Render an OT-SVG glyph with LunaSVG
+    bool renderSvgGlyph(void* ftFace, uint32_t glyphIndex);
+    
+    // Render PNG/CBDT bitmap strikes (embedded color bitmaps), box-filtered
+    // down when the strike is larger than the buffer
+    bool renderBitmapStrike(void* ftFace, uint32_t glyphIndex);
+    
+    // Render COLR v0 layers in palette colors
+    bool renderColorLayers(void* ftFace, uint32_t glyphIndex);
+    
+    // Render the plain outline in gray, for glyphs without color data
+    bool renderGrayscale(void* ftFace, uint32_t glyphIndex);
 };
 
 } // namespace ImBored::UI
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace ImBored::UI {
+
+// Composites a solid color through an 8-bit coverage mask onto RGBA pixels:
+//   fa      = coverage * a / 255
+//   dst.rgb = (rgb * fa + dst.rgb * (255 - fa)) / 255
+//   dst.a   = max(fa, dst.a)
+// Every division by 255 rounds to nearest, exactly, so all kernels write
+// identical bytes.
+using CompositeSpanFn = void (*)(uint8_t* dst, const uint8_t* coverage, size_t pixels, const uint8_t color[4]);
+
+// Draws premultiplied RGBA source pixels over premultiplied RGBA pixels,
+// scaled by an 8-bit coverage mask:
+//   s   = src * coverage / 255
+//   dst = s + dst * (255 - s.a) / 255
+using SrcOverSpanFn = void (*)(uint8_t* dst, const uint8_t* src, const uint8_t* coverage, size_t pixels);
+
+// Weighted sum of rows of bytes, one pass of a separable resampling
+// filter. Weights are in 1/256ths and sum to 256:
+//   dst[i] = (rows[0][i] * weights[0] + rows[1][i] * weights[1] + ... + 128) / 256
+using FilterRowsFn = void (*)(uint8_t* dst, const uint8_t* const* rows, const uint16_t* weights, size_t rowCount,
+                              size_t bytes);
+
+// Portable reference kernels
+void CompositeSpanScalar(uint8_t* dst, const uint8_t* coverage, size_t pixels, const uint8_t color[4]);
+void SrcOverSpanScalar(uint8_t* dst, const uint8_t* src, const uint8_t* coverage, size_t pixels);
+void FilterRowsScalar(uint8_t* dst, const uint8_t* const* rows, const uint16_t* weights, size_t rowCount, size_t bytes);
+
+// One implementation of every kernel
+struct CompositeKernelSet {
+    CompositeSpanFn composite;
+    SrcOverSpanFn srcOver;
+    FilterRowsFn filterRows;
+    const char* name;
+};
+
+// Every kernel set this build can run on this CPU, fastest first and
+// scalar last, so each can be checked against the reference
+std::vector<CompositeKernelSet> GetAvailableCompositeKernels();
+
+// Fastest kernels for this CPU (AVX2, SSE2, NEON or scalar), picked once
+CompositeSpanFn GetCompositeSpanKernel();
+SrcOverSpanFn GetSrcOverSpanKernel();
+FilterRowsFn GetFilterRowsKernel();
+
+// Name of the kernel set the getters return, for logs
+const char* GetCompositeSpanKernelName();
+
+} // namespace ImBored::UI
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "ui/emoji_atlas_page.hpp"
+
+namespace ImBored::UI {
+
+// Everything that invalidates a cached atlas
+struct EmojiAtlasCacheKey {
+    uint64_t fontHash;        // hashFont() of the font, folded over a fallback chain
+    uint32_t pixelSize;       // Rasterization size
+    uint32_t rendererVersion; // COLRv1Renderer::RENDER_VERSION
+};
+
+// Placement of one rasterized glyph
+struct EmojiAtlasCacheEntry {
+    uint32_t codepoint;
+    uint32_t glyphIndex;
+    uint32_t page;
+    int32_t atlasX;
+    int32_t atlasY;
+    int32_t inkX;       // Trimmed rect inside the original glyph box
+    int32_t inkY;
+    int32_t inkWidth;
+    int32_t inkHeight;
+};
+
+// Versioned on-disk cache of rasterized emoji atlases.
+// One file per font and pixel size; files are read through mmap and
+// replaced atomically so a crash never leaves a half-written cache.
+class EmojiAtlasCache {
+public:
+    EmojiAtlasCache();
+    
+    void setDirectory(const std::string& directory) { m_directory = directory; }
+    const std::string& getDirectory() const { return m_directory; }
+    
+    // Load a cached atlas; fails if the file is missing, stale or corrupt
+    bool load(const EmojiAtlasCacheKey& key, std::vector<std::unique_ptr<EmojiAtlasPage>>& pages,
+              std::vector<EmojiAtlasCacheEntry>& glyphs) const;
+    
+    // Write the atlas to a uniquely named temp file, fsync it and rename it
+    // over the old one
+    bool store(const EmojiAtlasCacheKey& key, const std::vector<std::unique_ptr<EmojiAtlasPage>>& pages,
+               const std::vector<EmojiAtlasCacheEntry>& glyphs) const;
+    
+    // Fast non-cryptographic 64-bit hash used for keys and payload checks
+    static uint64_t hashBytes(const uint8_t* data, size_t size);
+    
+    // Font identity for cache keys. Hashes the sfnt table directory, whose
+    // records carry per-table checksums, so the glyph data is never paged
+    // in; falls back to hashBytes for other layouts.
+    static uint64_t hashFont(const uint8_t* data, size_t size);
+    
+    // Per-user cache location (XDG_CACHE_HOME, LOCALAPPDATA, ...)
+    static std::string defaultDirectory();
+    
+private:
+    std::string pathFor(const EmojiAtlasCacheKey& key) const;
+    
+    std::string m_directory;
+};
+
+} // namespace ImBored::UI
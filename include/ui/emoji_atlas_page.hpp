@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "ui/skyline_packer.hpp"
+
+namespace ImBored::UI {
+
+// Region of an atlas page in pixels
+struct AtlasRect {
+    int x, y, width, height;
+};
+
+// One texture of the emoji atlas: CPU-side RGBA pixels, the packer that
+// fills them and the GL texture they are uploaded to
+class EmojiAtlasPage {
+public:
+    EmojiAtlasPage(int width, int height);
+    ~EmojiAtlasPage();
+    
+    EmojiAtlasPage(const EmojiAtlasPage&) = delete;
+    EmojiAtlasPage& operator=(const EmojiAtlasPage&) = delete;
+    
+    // Reserve a width x height rect from freed slots or the packer.
+    // Returns false when the page cannot hold it at its current size.
+    bool allocate(int width, int height, int& x, int& y);
+    
+    // Count a rect restored from the disk cache as live
+    void retain(const AtlasRect& rect) {
+        m_liveRects++;
+        m_liveArea += static_cast<int64_t>(rect.width) * rect.height;
+    }
+    
+    // Return an evicted rect for reuse. Its pixels are cleared so stale ink
+    // never bleeds into the padding of the next occupant, and it is merged
+    // with free neighbours; once nothing is live the whole page is reset.
+    void release(const AtlasRect& rect);
+    
+    // Double the shorter side; canGrow() checks against a size limit
+    bool canGrow(int maxSize) const { return m_width < maxSize || m_height < maxSize; }
+    void grow();
+    
+    // Extra CPU-side bytes the next grow() would take (the GPU copy matches)
+    size_t getGrowthBytes() const { return m_pixels.size(); }
+    
+    // Copy RGBA rows into the page and mark the region for upload
+    void write(int x, int y, int width, int height, const uint8_t* src, size_t srcStride);
+    
+    // Replace packer state and pixels (disk cache)
+    void restore(const std::vector<SkylineNode>& skyline, int64_t usedArea, const uint8_t* pixels);
+    
+    // Bring the GL texture up to date, uploading only dirty regions
+    void upload();
+    
+    void* getTextureID() const { return m_textureID; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    const std::vector<uint8_t>& getPixels() const { return m_pixels; }
+    const SkylinePacker& getPacker() const { return m_packer; }
+    size_t getBytes() const { return m_pixels.size(); }
+    
+    // Area of the rects in use; unlike the packer's, it drops on release()
+    int64_t getLiveArea() const { return m_liveArea; }
+    
+private:
+    void clear(int x, int y, int width, int height);
+    
+    // Add a rect to the free list, merging it with free rects that share a
+    // whole edge with it
+    void addFreeRect(AtlasRect rect);
+    
+    int m_width;
+    int m_height;
+    std::vector<uint8_t> m_pixels;
+    SkylinePacker m_packer;
+    
+    // Evicted slots, reused before the skyline, and rects in use
+    std::vector<AtlasRect> m_freeRects;
+    int m_liveRects;
+    int64_t m_liveArea;
+    
+    // GPU storage size and regions changed since the last upload
+    void* m_textureID;
+    int m_textureWidth;
+    int m_textureHeight;
+    std::vector<AtlasRect> m_dirtyRects;
+};
+
+} // namespace ImBored::UI
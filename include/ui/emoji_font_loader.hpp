@@ -0,0 +1,20 @@
+#pragma once
+
+#include "imgui.h"
+
+struct ImFontLoader;
+
+namespace ImBored::UI {
+
+class EmojiManager;
+
+// ImGui 1.92 font loader that serves color emoji from an EmojiManager.
+// Glyphs are rasterized on demand for every baked size and packed into
+// the main ImFontAtlas, so plain ImGui::Text draws them with the text.
+const ImFontLoader* GetEmojiFontLoader();
+
+// Merge color emoji into dstFont (the last added font when null).
+// The emoji manager must be initialized and outlive the atlas source.
+ImFont* MergeEmojiFont(ImFontAtlas* atlas, EmojiManager* emojiManager, ImFont* dstFont = nullptr);
+
+} // namespace ImBored::UI
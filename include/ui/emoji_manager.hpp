@@ -1,17 +1,46 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
 #include <vector>
+#include <memory>
 #include <cstdint>
 
+#include "ui/emoji_atlas_cache.hpp"
+#include "ui/emoji_atlas_page.hpp"
+#include "ui/codepoint_table.hpp"
+
 namespace ImBored::UI {
 
+class COLRv1Renderer;
+class GlyphRasterPool;
+class GlyphCache;
+class BitmapResampler;
+
 struct EmojiGlyph {
     uint32_t codepoint;
+    uint32_t glyphIndex;    // Glyph index in the font face
+    int font;               // Fallback chain font the glyph comes from
     float u0, v0, u1, v1;  // UV coordinates in atlas
     float width, height;    // Original size
     float advance;          // Horizontal advance
+    float x0, y0, x1, y1;   // Quad inside the original box after trimming transparent borders
+    int page;               // Atlas page (texture) holding the glyph
+    int atlasX, atlasY;     // Trimmed rect position in its page (pixels)
+    bool resident;          // Rasterized into the atlas
+    bool queued;            // Waiting for rasterization
+    uint64_t lastUsedFrame; // Last frame SmartText drew it (LRU eviction)
+};
+
+// Lazy glyph cache counters
+struct EmojiCacheStats {
+    uint64_t hits;          // Lookups served from the atlas
+    uint64_t misses;        // Lookups that had to wait for rasterization
+    uint64_t evictions;     // Glyphs dropped to stay within the memory budget
+    size_t residentGlyphs;  // Glyphs currently in the atlas
+    size_t pendingGlyphs;   // Glyphs queued for the next update()
+    size_t atlasPages;      // Textures backing the atlas
+    size_t atlasBytes;      // CPU-side atlas size (the GPU copy matches)
+    float atlasOccupancy;   // Resident glyph area / atlas area, 0..1
 };
 
 class EmojiManager {
@@ -22,39 +51,146 @@ public:
     // Initialize and load emojis from font file
     bool initialize(const char* fontPath, float fontSize);
     
-    // Re-rasterize at new size
+    // Initialize from an ordered fallback chain: every emoji comes from the
+    // first font whose cmap covers it. Fonts that fail to load are skipped.
+    bool initialize(const std::vector<std::string>& fontPaths, float fontSize);
+    
+    // Fonts in the fallback chain that loaded
+    int getFontCount() const { return static_cast<int>(m_fonts.size()); }
+    
+    // Directory for persisted atlases (set before initialize)
+    void setCacheDirectory(const std::string& directory) { m_diskCache.setDirectory(directory); }
+    
+    // Upper bound for atlas pixels in bytes, 0 for unlimited. Least recently
+    // drawn glyphs are evicted to make room once it is reached.
+    void setMemoryBudget(size_t bytes) { m_memoryBudget = bytes; }
+    size_t getMemoryBudget() const { return m_memoryBudget; }
+    
+    // Byte budget for cached FreeType outlines and bitmaps, shared by the
+    // main thread and the raster workers (set before initialize)
+    void setGlyphCacheBudget(size_t bytes) { m_glyphCacheBudget = bytes; }
+    size_t getGlyphCacheBudget() const { return m_glyphCacheBudget; }
+    
+    // Re-rasterize at new size. The rebuild runs in the background; until
+    // update() swaps it in, glyphs come from the old atlas and are drawn
+    // scaled by getDrawScale().
     void setFontSize(float newSize);
     
-    // Get emoji glyph data
-    const EmojiGlyph* getEmoji(uint32_t codepoint) const;
+    // Scale to apply to glyph metrics while a size change is pending, 1 otherwise
+    float getDrawScale() const { return m_drawScale; }
+    
+    // Get emoji glyph data, queues rasterization on first use.
+    // Non-resident glyphs are returned with resident == false so callers
+    // can reserve their advance until the next update().
+    const EmojiGlyph* getEmoji(uint32_t codepoint);
+    
+    // Record that a glyph is drawn this frame; it will not be evicted
+    // before the next update()
+    void markUsed(const EmojiGlyph* emoji);
+    
+    // Rasterize queued glyphs and upload changed atlas regions (call once per frame)
+    void update();
     
-    // Get texture ID for ImGui
-    void* getTextureID() const { return m_textureID; }
+    // Get texture ID of an atlas page for ImGui
+    void* getTextureID(int page) const { return m_pages[page]->getTextureID(); }
     
-    // Get atlas dimensions
-    int getAtlasWidth() const { return m_atlasWidth; }
-    int getAtlasHeight() const { return m_atlasHeight; }
+    // Get atlas page count and dimensions
+    int getPageCount() const { return static_cast<int>(m_pages.size()); }
+    int getAtlasWidth(int page) const { return m_pages[page]->getWidth(); }
+    int getAtlasHeight(int page) const { return m_pages[page]->getHeight(); }
+    
+    // Rasterize one emoji into a pixelSize x pixelSize RGBA buffer,
+    // independent of the atlas (used by the ImGui font loader)
+    bool rasterizeGlyph(uint32_t codepoint, int pixelSize, std::vector<uint8_t>& pixels);
     
     // Check if codepoint is an emoji
     bool isEmoji(uint32_t codepoint) const;
     
+    // Lazy cache hit/miss counters
+    const EmojiCacheStats& getCacheStats() const { return m_stats; }
+    
 private:
+    struct RebuildJob;
+    struct CacheWriteJob;
+    struct EmojiFont;
+    
+    // Two loads through the lookup table, no hashing or font probing
+    EmojiGlyph* findGlyph(uint32_t codepoint) {
+        int index = m_lookup.find(codepoint);
+        return index >= 0 ? &m_glyphs[index] : nullptr;
+    }
+    
+    bool loadFont(const std::string& path);
+    void resolveGlyphs();
     void buildAtlas();
-    void createTexture();
-    bool extractSVG(uint32_t codepoint, std::string& svgData);
+    void resetAtlas();
+    EmojiAtlasPage& addPage();
+    bool allocateRect(int width, int height, int& page, int& x, int& y);
+    bool allocateOnPage(int page, int width, int height, int& x, int& y);
+    int evictLeastRecentlyUsed();
+    size_t getAtlasBytes() const;
+    bool withinBudget(size_t extraBytes) const;
+    void rasterizePending();
+    bool placeGlyph(EmojiGlyph& emoji, const uint8_t* pixels);
+    void updateUVs(EmojiGlyph& emoji);
+    void updateAtlasStats();
+    bool loadAtlasCache();
+    bool restoreAtlas(std::vector<std::unique_ptr<EmojiAtlasPage>>& pages,
+                      const std::vector<EmojiAtlasCacheEntry>& entries);
+    std::vector<EmojiAtlasCacheEntry> collectCacheEntries() const;
+    void saveAtlasCache();
+    void saveAtlasCacheAsync();
+    void finishCacheWrite(bool wait);
+    EmojiAtlasCacheKey cacheKey(int pixelSize) const;
+    void startRebuild(float fontSize);
+    void runRebuild(RebuildJob& job);
+    void finishRebuild();
     
-    std::unordered_map<uint32_t, EmojiGlyph> m_emojiGlyphs;
-    std::string m_fontPath;
+    // Glyph records, contiguous and never reallocated after initialize()
+    std::vector<EmojiGlyph> m_glyphs;
+    // Codepoint -> glyph record, already resolved to a font of the chain
+    CodepointTable m_lookup;
+    std::vector<EmojiGlyph*> m_pending;
     float m_fontSize;
     
-    // Texture data
-    void* m_textureID;
-    std::vector<uint8_t> m_atlasData;
-    int m_atlasWidth;
-    int m_atlasHeight;
+    // Fallback chain in priority order
+    std::vector<std::unique_ptr<EmojiFont>> m_fonts;
+    
+    // Atlas pages, each its own texture
+    int m_pixelSize;
+    int m_maxPageSize;
+    std::vector<std::unique_ptr<EmojiAtlasPage>> m_pages;
+    
+    // LRU eviction: budget, frame counter and oldest-last candidates
+    size_t m_memoryBudget;
+    uint64_t m_frame;
+    std::vector<EmojiGlyph*> m_evictionQueue;
+    bool m_evictionQueueReady;
+    
+    // Background setFontSize() rebuild
+    std::unique_ptr<RebuildJob> m_rebuild;
+    float m_targetFontSize;
+    float m_drawScale;
+    
+    EmojiCacheStats m_stats;
+    
+    // Persisted atlas
+    EmojiAtlasCache m_diskCache;
+    uint64_t m_fontHash;
+    bool m_atlasDirty;
+    std::unique_ptr<CacheWriteJob> m_cacheWrite;
+    
+    // FreeType glyph cache for the main thread's faces
+    size_t m_glyphCacheBudget;
+    std::unique_ptr<GlyphCache> m_glyphCache;
+    
+    std::unique_ptr<GlyphRasterPool> m_rasterPool;
+    
+    // rasterizeGlyph() downscaling for the ImGui font loader
+    std::unique_ptr<BitmapResampler> m_resampler;
+    std::vector<uint8_t> m_resampleBuffer;  // Premultiplied copy of the rendered glyph
     
-    // FreeType font face
-    void* m_ftFace;  // FT_Face
+    // FreeType library owning every main thread face
     void* m_ftLibrary; // FT_Library
 };
 
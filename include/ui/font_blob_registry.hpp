@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "core/mapped_file.hpp"
+
+struct ImFont;
+struct ImFontAtlas;
+struct ImFontConfig;
+
+namespace ImBored::UI {
+
+// Process-wide table of memory-mapped font files. Every file is mapped once
+// and stays mapped until exit, so FreeType faces on any thread and ImGui
+// font sources all point into the same read-only pages instead of each
+// holding a heap copy.
+class FontBlobRegistry {
+public:
+    static FontBlobRegistry& get();
+    
+    FontBlobRegistry(const FontBlobRegistry&) = delete;
+    FontBlobRegistry& operator=(const FontBlobRegistry&) = delete;
+    
+    // Mapping of the font at path, nullptr if it cannot be mapped.
+    // Thread-safe; the mapping lives as long as the registry.
+    const Core::MappedFile* acquire(const std::string& path);
+    
+    // FT_New_Memory_Face over a mapped font. Returns an FT_Face owned by the
+    // caller (FT_Done_Face it before the library), nullptr on failure.
+    static void* newFace(void* ftLibrary, const Core::MappedFile& font, long faceIndex = 0);
+    
+    // Add an ImGui font reading the mapped bytes. AddFont duplicates FontData
+    // when the atlas doesn't own it, so the font goes through a forwarding
+    // loader that skips that copy; a config with its own FontLoader is copied
+    ImFont* addImGuiFont(ImFontAtlas* atlas, const std::string& path, float sizePixels,
+                         const ImFontConfig* config = nullptr);
+    
+    // Total size of all mapped fonts
+    size_t getMappedBytes() const;
+    
+private:
+    FontBlobRegistry() = default;
+    
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<Core::MappedFile>> m_files;
+};
+
+} // namespace ImBored::UI
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "core/mapped_file.hpp"
+
+namespace ImBored::UI {
+
+// Glyph bitmap handed out by GlyphCache. The pixels belong to the cache
+// and stay valid until the next lookup.
+struct CachedGlyphBitmap {
+    const uint8_t* buffer;
+    int width, height;
+    int pitch;
+    int left, top;      // Bearings in pixels, top is up from the baseline
+    int pixelMode;      // FT_Pixel_Mode
+};
+
+// Glyph outlines and bitmaps kept by FreeType's cache subsystem
+// (FTC_Manager with an FTC_SBitCache and an FTC_ImageCache) under a byte
+// budget. Entries are keyed by face, pixel size and load flags, so going
+// back to a size that was rendered before skips FT_Load_Glyph.
+// FTC is not thread-safe: use one cache per FT_Library and thread.
+class GlyphCache {
+public:
+    GlyphCache(void* ftLibrary, size_t maxBytes);
+    ~GlyphCache();
+    
+    GlyphCache(const GlyphCache&) = delete;
+    GlyphCache& operator=(const GlyphCache&) = delete;
+    
+    // Register a mapped font; the cache opens its own face over it on
+    // demand. Returns the id used by lookupGlyph().
+    int addFace(const Core::MappedFile& font, long faceIndex = 0);
+    
+    // Glyph at xPixels x yPixels with the given FT_LOAD_* flags. Bitmaps
+    // (color strikes, small glyphs the sbit cache holds as 8-bit coverage)
+    // come back in `bitmap`. Other outlines are not rendered here: they come
+    // back through `outline` as the cache's own FT_Outline, valid until the
+    // next lookup, or fail the lookup when outline is null. Callers may move
+    // the outline while drawing it but must put it back.
+    bool lookupGlyph(int face, int xPixels, int yPixels, uint32_t glyphIndex, int32_t loadFlags,
+                     CachedGlyphBitmap& bitmap, void** outline = nullptr);
+    
+    size_t getMaxBytes() const { return m_maxBytes; }
+    
+private:
+    struct FaceSource {
+        const Core::MappedFile* font;
+        long faceIndex;
+    };
+    
+    void* m_ftLibrary;      // FT_Library
+    void* m_manager;        // FTC_Manager
+    void* m_sbitCache;      // FTC_SBitCache
+    void* m_imageCache;     // FTC_ImageCache
+    size_t m_maxBytes;
+    
+    // Face ids point at these, so entries never move
+    std::vector<std::unique_ptr<FaceSource>> m_faces;
+};
+
+} // namespace ImBored::UI
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+#include "core/mapped_file.hpp"
+
+namespace ImBored::UI {
+
+class COLRv1Renderer;
+class SvgGlyphTable;
+class SvgDocumentCache;
+class GlyphCache;
+
+struct GlyphRasterJob {
+    uint32_t glyphIndex;
+    uint32_t codepoint;
+    uint32_t font;      // Index into the pool's font list
+};
+
+// One font the pool rasterizes from. Both pointers must outlive the pool;
+// svgTable is optional.
+struct GlyphRasterFont {
+    const Core::MappedFile* file;
+    const SvgGlyphTable* svgTable;
+};
+
+// Output of a batch. Glyph i's pixelSize x pixelSize RGBA cell starts at
+// row i * pixelSize of one pixelSize-wide slab, which the workers render
+// into directly.
+struct GlyphRasterBatch {
+    int pixelSize;
+    std::vector<uint8_t> pixels;
+    std::vector<uint8_t> rendered;  // Per glyph, 1 if its cell holds it
+    
+    const uint8_t* getPixels(size_t glyph) const {
+        return pixels.data() + glyph * pixelSize * pixelSize * 4;
+    }
+};
+
+// Rasterizes batches of glyphs on persistent worker threads.
+// Threads start when a batch first needs them and run until the pool is
+// destroyed. Each one owns its FT_Library and, per font, an FT_Face and a
+// COLRv1Renderer, all set up on that thread and kept between batches; the
+// faces are opened over the shared font mappings. Each worker parses SVG
+// documents into its own cache. glyphCacheBytes is split between the
+// workers' FreeType glyph caches.
+class GlyphRasterPool {
+public:
+    GlyphRasterPool(const std::vector<GlyphRasterFont>& fonts, size_t glyphCacheBytes = 0);
+    ~GlyphRasterPool();
+    
+    GlyphRasterPool(const GlyphRasterPool&) = delete;
+    GlyphRasterPool& operator=(const GlyphRasterPool&) = delete;
+    
+    // Rasterize all jobs and wait for them; cell i of the batch belongs to
+    // jobs[i] regardless of which worker rendered it. One caller at a time.
+    void rasterize(const std::vector<GlyphRasterJob>& jobs, float fontSize, int pixelSize,
+                   GlyphRasterBatch& batch);
+    
+    // Apply the strike/pixel size used for atlas rasterization to a face.
+    // Bitmap-only faces get the smallest strike at least pixelSize tall,
+    // which the renderer then scales down. Shared with EmojiManager so
+    // serial and parallel output match exactly.
+    static void configureFace(void* ftFace, int pixelSize);
+    
+    // Worker count used for a batch of the given size
+    static unsigned workerCountFor(size_t jobCount);
+    
+private:
+    struct WorkerFace {
+        void* ftFace;     // FT_Face
+        std::unique_ptr<SvgDocumentCache> svgDocuments;
+        int glyphCacheFace;
+        std::unique_ptr<COLRv1Renderer> renderer;
+    };
+    
+    // State of one worker thread, only ever touched by that thread
+    struct Worker {
+        void* ftLibrary;  // FT_Library
+        std::unique_ptr<GlyphCache> glyphCache;
+        std::vector<WorkerFace> faces; // Parallel to m_fonts
+        float fontSize;
+        int pixelSize;
+    };
+    
+    // The batch rasterize() is waiting on
+    struct BatchTask {
+        const std::vector<GlyphRasterJob>* jobs;
+        const uint32_t* order;      // Job indices by font, then glyph
+        GlyphRasterBatch* batch;
+        float fontSize;
+        size_t runsLeft;            // Guarded by m_mutex
+    };
+    
+    // Jobs order[begin, end) of a batch, the unit workers take off the queue
+    struct Run {
+        BatchTask* task;
+        size_t begin;
+        size_t end;
+    };
+    
+    void workerMain();
+    bool prepareWorker(Worker& worker, float fontSize, int pixelSize);
+    void renderRun(Worker& worker, const Run& run);
+    static void releaseWorker(Worker& worker);
+    
+    std::vector<GlyphRasterFont> m_fonts;
+    size_t m_glyphCacheBytes;
+    
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_workReady;
+    std::condition_variable m_batchDone;
+    std::deque<Run> m_queue;
+    bool m_stopping;
+};
+
+} // namespace ImBored::UI
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+namespace ImBored::UI {
+
+// A COLRv1 paint graph flattened into a resolution-independent list of
+// drawing ops, in font units. Nested COLR glyphs are inlined, palette
+// colors resolved (palette 0) and clip glyph outlines copied out of the
+// face, so replaying a list at any size needs no COLR table access and no
+// FT_Load_Glyph. Lists are immutable once compiled and shared between
+// threads.
+struct PaintDisplayList {
+    enum OpType : uint8_t {
+        OP_FILL,        // Fill the current clip with fills[data]
+        OP_TRANSFORM,   // Draw ops up to `end` with transforms[data] applied
+        OP_CLIP,        // Draw ops up to `end` clipped to outlines[data]
+        OP_COMPOSITE,   // Backdrop is ops up to `data`, source from there to `end`
+    };
+    
+    struct Op {
+        uint8_t type;
+        uint8_t mode;   // FT_Composite_Mode for OP_COMPOSITE
+        uint32_t data;
+        uint32_t end;   // One past the last op of the group
+    };
+    
+    // x' = xx * x + xy * y + dx, y' = yx * x + yy * y + dy
+    struct Transform {
+        float xx, xy, dx;
+        float yx, yy, dy;
+    };
+    
+    struct Outline {
+        uint32_t firstPoint, pointCount;
+        uint32_t firstContour, contourCount;
+        int flags;      // FT_OUTLINE_* flags
+    };
+    
+    struct Fill {
+        uint8_t format;     // FT_PaintFormat: solid, linear, radial or sweep
+        uint8_t extend;     // FT_PaintExtend
+        uint32_t firstStop, stopCount;
+        float color[4];     // Solid fills: premultiplied RGBA
+        
+        // Linear: p0, p1, p2. Radial: c0, r0, c1, r1. Sweep: center, start
+        // and end angle in units of 180 degrees.
+        float geometry[6];
+    };
+    
+    std::vector<Op> ops;
+    std::vector<Transform> transforms;
+    std::vector<Fill> fills;
+    std::vector<float> stops;           // offset, premultiplied r, g, b, a; sorted per fill
+    std::vector<Outline> outlines;
+    std::vector<float> points;          // x, y in font units
+    std::vector<uint8_t> tags;          // FT_CURVE_TAG per point
+    std::vector<uint16_t> contours;     // Last point of each contour
+    
+    size_t getBytes() const;
+};
+
+// Process-wide cache of compiled display lists, keyed by font bytes, face
+// index and glyph. Faces must be memory faces over bytes that outlive the
+// cache (FontBlobRegistry mappings), since the bytes identify the font.
+// Glyphs without a paint graph are remembered too. Thread-safe.
+class PaintDisplayListCache {
+public:
+    static PaintDisplayListCache& get();
+    
+    PaintDisplayListCache(const PaintDisplayListCache&) = delete;
+    PaintDisplayListCache& operator=(const PaintDisplayListCache&) = delete;
+    
+    // Compiled list for a glyph, compiling it through ftFace on first use.
+    // nullptr if the glyph has no COLRv1 paint graph.
+    std::shared_ptr<const PaintDisplayList> acquire(void* ftFace, uint32_t glyphIndex);
+    
+    // Memory held by the cached lists
+    size_t getBytes() const;
+    
+private:
+    PaintDisplayListCache();
+    
+    struct Key {
+        const void* font;
+        long faceIndex;
+        uint32_t glyphIndex;
+        bool operator==(const Key& other) const {
+            return font == other.font && faceIndex == other.faceIndex && glyphIndex == other.glyphIndex;
+        }
+    };
+    
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    
+    mutable std::mutex m_mutex;
+    std::unordered_map<Key, std::shared_ptr<const PaintDisplayList>, KeyHash> m_lists;
+    size_t m_bytes;
+};
+
+} // namespace ImBored::UI
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ImBored::UI {
+
+// One horizontal segment of the skyline: [x, x + width) is filled up to y
+struct SkylineNode {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+};
+
+// Bottom-left skyline rectangle packer.
+// The skyline itself only grows: EmojiAtlasPage keeps evicted rects in its
+// own free list and resets the packer once the page is empty.
+class SkylinePacker {
+public:
+    SkylinePacker();
+    
+    // Start over with an empty area
+    void reset(int width, int height);
+    
+    // Enlarge the packing area, keeping everything already placed
+    void grow(int width, int height);
+    
+    // Restore a previously saved skyline
+    void restore(int width, int height, const std::vector<SkylineNode>& nodes, int64_t usedArea);
+    
+    // Find a spot for a width x height rectangle; false if it does not fit
+    bool pack(int width, int height, int& x, int& y);
+    
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    const std::vector<SkylineNode>& getNodes() const { return m_nodes; }
+    
+    // Area of all rectangles packed since the last reset. The skyline
+    // never gives space back, so evictions don't lower it.
+    int64_t getUsedArea() const { return m_usedArea; }
+    
+    // Packed area relative to the whole area, 0..1
+    float getOccupancy() const;
+    
+private:
+    // Lowest y where a rectangle of the given size fits starting at node index
+    bool fitAt(size_t index, int width, int height, int& y) const;
+    void mergeNodes();
+    
+    int m_width;
+    int m_height;
+    int64_t m_usedArea;
+    std::vector<SkylineNode> m_nodes;
+};
+
+} // namespace ImBored::UI
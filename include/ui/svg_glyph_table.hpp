@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace lunasvg {
+class Document;
+}
+
+namespace ImBored::UI {
+
+// One entry of the OpenType SVG document list: glyphs
+// [startGlyph, endGlyph] are drawn by the same document
+struct SvgDocumentRange {
+    uint16_t startGlyph;
+    uint16_t endGlyph;
+    uint32_t offset;    // From the start of the document list
+    uint32_t length;
+};
+
+// Read-only view of a font's 'SVG ' table over the font bytes, which must
+// outlive it. Safe to share between threads.
+class SvgGlyphTable {
+public:
+    SvgGlyphTable();
+    
+    // Locate and index the table; false when the font has none
+    bool load(const uint8_t* fontData, size_t fontDataSize);
+    
+    bool empty() const { return m_ranges.empty(); }
+    
+    // Document range holding a glyph, or nullptr
+    const SvgDocumentRange* find(uint32_t glyphIndex) const;
+    
+    // Raw (possibly gzip-compressed) document bytes
+    const uint8_t* getDocumentData(const SvgDocumentRange& range) const { return m_documents + range.offset; }
+    
+private:
+    const uint8_t* m_documents;
+    std::vector<SvgDocumentRange> m_ranges;
+};
+
+// Parsed SVG documents keyed by document range, so glyphs sharing a
+// document and re-rasterization at new sizes never parse the XML twice.
+// LunaSVG documents are not thread-safe: use one cache per thread.
+class SvgDocumentCache {
+public:
+    explicit SvgDocumentCache(const SvgGlyphTable* table);
+    ~SvgDocumentCache();
+    
+    SvgDocumentCache(const SvgDocumentCache&) = delete;
+    SvgDocumentCache& operator=(const SvgDocumentCache&) = delete;
+    
+    // Document drawing a glyph, nullptr if there is none or it failed to
+    // parse. range receives the glyph's document range.
+    lunasvg::Document* getDocument(uint32_t glyphIndex, const SvgDocumentRange** range = nullptr);
+    
+    size_t getDocumentCount() const { return m_documents.size(); }
+    
+private:
+    const SvgGlyphTable* m_table;
+    std::unordered_map<uint64_t, std::unique_ptr<lunasvg::Document>> m_documents;
+};
+
+} // namespace ImBored::UI
@@ -12,6 +12,8 @@
 #include "include/rendering/renderer.hpp"
 #include "include/ui/emoji_manager.hpp"
 #include "include/ui/smart_text.hpp"
+#include "include/ui/emoji_font_loader.hpp"
+#include "include/ui/font_blob_registry.hpp"
 
 using namespace ImBored::Core;
 using namespace ImBored::Rendering;
@@ -55,10 +57,8 @@ int main() {
         std::cout << "DEBUG: Loading main font...\n";
         auto font_start = std::chrono::high_resolution_clock::now();
         
-        ImFontConfig config;
-        config.FontDataOwnedByAtlas = false;
-        
-        ImFont* mainFont = io.Fonts->AddFontFromFileTTF("resources/Quicksand-Regular.ttf", 18.0f, &config);
+        // Mapped once; the atlas reads the mapping without copying it
+        ImFont* mainFont = FontBlobRegistry::get().addImGuiFont(io.Fonts, "resources/Quicksand-Regular.ttf", 18.0f);
         std::cout << "DEBUG: Main font loaded\n";
         
         // Build font atlas (no emoji glyphs)
@@ -80,13 +80,19 @@ int main() {
         std::cout << "DEBUG: Initializing emoji manager...\n";
         auto emoji_start = std::chrono::high_resolution_clock::now();
         EmojiManager emojiManager;
-        bool emojiSuccess = emojiManager.initialize("resources/NotoColorEmoji-Regular.ttf", 18.0f);
+        emojiManager.setMemoryBudget(64 * 1024 * 1024);
+        // Noto first; Twitter fills in anything Noto lacks
+        bool emojiSuccess = emojiManager.initialize({"resources/NotoColorEmoji-Regular.ttf",
+                                                     "resources/TwitterColorEmoji.ttf"}, 18.0f);
         auto emoji_end = std::chrono::high_resolution_clock::now();
         auto emoji_duration = std::chrono::duration_cast<std::chrono::milliseconds>(emoji_end - emoji_start);
         
         if (emojiSuccess) {
             std::cout << "DEBUG: Emoji manager initialized in " << emoji_duration.count() << "ms\n";
             SmartTextInit(&emojiManager);
+            
+            // Color emoji in the main font too, so plain ImGui text shows them
+            MergeEmojiFont(io.Fonts, &emojiManager, mainFont);
         } else {
             std::cerr << "WARNING: Failed to initialize emoji manager\n";
         }
@@ -96,6 +102,11 @@ int main() {
         while (window.isOpen()) {
             window.pollEvents();
             
+            // Rasterize and upload emojis requested during the last frame
+            if (emojiSuccess) {
+                emojiManager.update();
+            }
+            
             // Start a new ImGui frame
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
@@ -120,12 +131,28 @@ int main() {
                 SmartText("Sports: ⚽ 🏀 🏈 ⚾ 🎾 🏐 🏉 🥏 🎱 🎳 🏓 🏸 🥊 🥋");
                 SmartText("Symbols: ❤️ 💔 💕 💖 💗 💙 💚 💛 🖤 🤍 🤎 💝 💞");
                 SmartText("Nature: ☀️ 🌤️ ⛅ 🌥️ ☁️ 🌦️ 🌧️ ⛈️ 🌩️ 🌨️ ❄️ ☃️ ⚡ 🌈");
+                
+                ImGui::Spacing();
+                ImGui::Text("Merged into the main font: 😀 🐶 🍕 🚗 ⚽ 🌈");
+                ImGui::Button("Button 👍");
             } else {
                 ImGui::Text("Emoji manager failed to initialize");
             }
             
             ImGui::Spacing();
             ImGui::Text("Rendered using SVG extraction from NotoColorEmoji-Regular.ttf");
+            
+            if (emojiSuccess) {
+                const EmojiCacheStats& stats = emojiManager.getCacheStats();
+                ImGui::Text("Emoji cache: %zu resident, %zu pending, %llu hits, %llu misses, %llu evictions",
+                            stats.residentGlyphs, stats.pendingGlyphs,
+                            static_cast<unsigned long long>(stats.hits),
+                            static_cast<unsigned long long>(stats.misses),
+                            static_cast<unsigned long long>(stats.evictions));
+                ImGui::Text("Emoji atlas: %zu pages, %.1f KB, %.0f%% occupied",
+                            stats.atlasPages, stats.atlasBytes / 1024.0, stats.atlasOccupancy * 100.0f);
+                ImGui::Text("Mapped fonts: %.1f MB", FontBlobRegistry::get().getMappedBytes() / (1024.0 * 1024.0));
+            }
             ImGui::End();
 
             ImGui::ShowDemoWindow();
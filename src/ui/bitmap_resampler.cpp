@@ -0,0 +1,98 @@
+#include "ui/bitmap_resampler.hpp"
+#include "ui/composite_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ImBored::UI {
+
+BitmapResampler::BitmapResampler() {
+    m_rowTaps.srcSize = 0;
+    m_rowTaps.dstSize = 0;
+    m_columnTaps.srcSize = 0;
+    m_columnTaps.dstSize = 0;
+}
+
+void BitmapResampler::buildTaps(Taps& taps, int srcSize, int dstSize) {
+    if (taps.srcSize == srcSize && taps.dstSize == dstSize) {
+        return;
+    }
+    taps.srcSize = srcSize;
+    taps.dstSize = dstSize;
+    taps.taps.clear();
+    taps.weights.clear();
+    
+    // Output pixel i covers source [i * ratio, (i + 1) * ratio)
+    double ratio = static_cast<double>(srcSize) / dstSize;
+    for (int i = 0; i < dstSize; ++i) {
+        double start = i * ratio;
+        double end = std::min<double>(srcSize, (i + 1) * ratio);
+        int first = static_cast<int>(std::floor(start));
+        int last = std::min(srcSize, static_cast<int>(std::ceil(end)));
+        
+        Tap tap;
+        tap.first = static_cast<uint32_t>(first);
+        tap.count = static_cast<uint32_t>(last - first);
+        tap.weights = static_cast<uint32_t>(taps.weights.size());
+        
+        // Quantized weights must sum to exactly 256 so flat areas stay flat;
+        // the largest one absorbs the rounding
+        int sum = 0;
+        size_t largest = taps.weights.size();
+        for (int j = first; j < last; ++j) {
+            double overlap = std::min<double>(end, j + 1) - std::max<double>(start, j);
+            uint16_t weight = static_cast<uint16_t>(std::lround(overlap / ratio * 256.0));
+            taps.weights.push_back(weight);
+            if (weight > taps.weights[largest]) {
+                largest = taps.weights.size() - 1;
+            }
+            sum += weight;
+        }
+        taps.weights[largest] = static_cast<uint16_t>(taps.weights[largest] + 256 - sum);
+        taps.taps.push_back(tap);
+    }
+}
+
+void BitmapResampler::filterRows(const Taps& taps, const uint8_t* src, size_t srcPitch, size_t rowBytes, uint8_t* dst) {
+    static const FilterRowsFn filter = GetFilterRowsKernel();
+    
+    for (int i = 0; i < taps.dstSize; ++i) {
+        const Tap& tap = taps.taps[i];
+        m_rowPointers.resize(tap.count);
+        for (uint32_t k = 0; k < tap.count; ++k) {
+            m_rowPointers[k] = src + (tap.first + k) * srcPitch;
+        }
+        filter(dst + i * rowBytes, m_rowPointers.data(), &taps.weights[tap.weights], tap.count, rowBytes);
+    }
+}
+
+void BitmapResampler::transpose(const uint8_t* src, int width, int height, size_t srcPitch, uint8_t* dst) {
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = src + y * srcPitch;
+        for (int x = 0; x < width; ++x) {
+            std::memcpy(dst + (static_cast<size_t>(x) * height + y) * 4, row + x * 4, 4);
+        }
+    }
+}
+
+void BitmapResampler::downscale(const uint8_t* src, int srcWidth, int srcHeight, int srcPitch,
+                                uint8_t* dst, int dstWidth, int dstHeight) {
+    buildTaps(m_rowTaps, srcHeight, dstHeight);
+    buildTaps(m_columnTaps, srcWidth, dstWidth);
+    
+    // Rows first: srcWidth x dstHeight
+    size_t rowBytes = static_cast<size_t>(srcWidth) * 4;
+    m_filtered.resize(rowBytes * dstHeight);
+    filterRows(m_rowTaps, src, srcPitch, rowBytes, m_filtered.data());
+    
+    // Columns become rows, so the same kernel filters them
+    size_t columnBytes = static_cast<size_t>(dstHeight) * 4;
+    m_transposed.resize(columnBytes * srcWidth);
+    transpose(m_filtered.data(), srcWidth, dstHeight, rowBytes, m_transposed.data());
+    m_columns.resize(columnBytes * dstWidth);
+    filterRows(m_columnTaps, m_transposed.data(), columnBytes, columnBytes, m_columns.data());
+    
+    transpose(m_columns.data(), dstHeight, dstWidth, columnBytes, dst);
+}
+
+} // namespace ImBored::UI
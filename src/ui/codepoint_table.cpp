@@ -0,0 +1,28 @@
+#include "ui/codepoint_table.hpp"
+
+namespace ImBored::UI {
+
+CodepointTable::CodepointTable() {
+    clear();
+}
+
+void CodepointTable::clear() {
+    m_pageIndex.assign(MAX_CODEPOINT >> 8, 0);
+    m_entries.assign(256, 0);
+}
+
+void CodepointTable::insert(uint32_t codepoint, uint32_t index) {
+    if (codepoint >= MAX_CODEPOINT || index >= 0xFFFF) {
+        return;
+    }
+    
+    uint16_t& page = m_pageIndex[codepoint >> 8];
+    if (page == 0) {
+        page = static_cast<uint16_t>(m_entries.size() / 256);
+        m_entries.resize(m_entries.size() + 256, 0);
+    }
+    
+    m_entries[(static_cast<size_t>(page) << 8) | (codepoint & 0xFF)] = static_cast<uint16_t>(index + 1);
+}
+
+} // namespace ImBored::UI
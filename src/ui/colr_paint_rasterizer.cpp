@@ -0,0 +1,667 @@
+#include "ui/colr_paint_rasterizer.hpp"
+#include "ui/composite_kernels.hpp"
+#include "ui/paint_display_list.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// FreeType headers
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_COLOR_H
+#include FT_OUTLINE_H
+
+namespace ImBored::UI {
+
+static constexpr float PI = 3.14159265358979f;
+
+static uint32_t Div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static uint8_t ToByte(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// Blend modes from the W3C Compositing and Blending spec, on straight colors
+
+static float Screen(float cs, float cd) {
+    return cs + cd - cs * cd;
+}
+
+static float HardLight(float cs, float cd) {
+    return cs <= 0.5f ? cd * 2.0f * cs : Screen(cd, 2.0f * cs - 1.0f);
+}
+
+static float BlendChannel(int mode, float cs, float cd) {
+    switch (mode) {
+        case FT_COLR_COMPOSITE_SCREEN: return Screen(cs, cd);
+        case FT_COLR_COMPOSITE_OVERLAY: return HardLight(cd, cs);
+        case FT_COLR_COMPOSITE_DARKEN: return std::min(cs, cd);
+        case FT_COLR_COMPOSITE_LIGHTEN: return std::max(cs, cd);
+        case FT_COLR_COMPOSITE_COLOR_DODGE:
+            if (cd <= 0.0f) return 0.0f;
+            if (cs >= 1.0f) return 1.0f;
+            return std::min(1.0f, cd / (1.0f - cs));
+        case FT_COLR_COMPOSITE_COLOR_BURN:
+            if (cd >= 1.0f) return 1.0f;
+            if (cs <= 0.0f) return 0.0f;
+            return 1.0f - std::min(1.0f, (1.0f - cd) / cs);
+        case FT_COLR_COMPOSITE_HARD_LIGHT: return HardLight(cs, cd);
+        case FT_COLR_COMPOSITE_SOFT_LIGHT: {
+            if (cs <= 0.5f) {
+                return cd - (1.0f - 2.0f * cs) * cd * (1.0f - cd);
+            }
+            float d = cd <= 0.25f ? ((16.0f * cd - 12.0f) * cd + 4.0f) * cd : std::sqrt(cd);
+            return cd + (2.0f * cs - 1.0f) * (d - cd);
+        }
+        case FT_COLR_COMPOSITE_DIFFERENCE: return std::fabs(cs - cd);
+        case FT_COLR_COMPOSITE_EXCLUSION: return cs + cd - 2.0f * cs * cd;
+        case FT_COLR_COMPOSITE_MULTIPLY: return cs * cd;
+        default: return cs;
+    }
+}
+
+static float Lum(const float c[3]) {
+    return 0.3f * c[0] + 0.59f * c[1] + 0.11f * c[2];
+}
+
+static float Sat(const float c[3]) {
+    return std::max({c[0], c[1], c[2]}) - std::min({c[0], c[1], c[2]});
+}
+
+static void SetLum(float c[3], float lum) {
+    float delta = lum - Lum(c);
+    for (int i = 0; i < 3; ++i) c[i] += delta;
+    
+    // Clip back into gamut keeping the luminosity
+    float l = Lum(c);
+    float lo = std::min({c[0], c[1], c[2]});
+    float hi = std::max({c[0], c[1], c[2]});
+    if (lo < 0.0f && l - lo > 0.0f) {
+        for (int i = 0; i < 3; ++i) c[i] = l + (c[i] - l) * l / (l - lo);
+    }
+    if (hi > 1.0f && hi - l > 0.0f) {
+        for (int i = 0; i < 3; ++i) c[i] = l + (c[i] - l) * (1.0f - l) / (hi - l);
+    }
+}
+
+static void SetSat(float c[3], float sat) {
+    int lo = 0, mid = 1, hi = 2;
+    if (c[lo] > c[mid]) std::swap(lo, mid);
+    if (c[mid] > c[hi]) std::swap(mid, hi);
+    if (c[lo] > c[mid]) std::swap(lo, mid);
+    
+    if (c[hi] > c[lo]) {
+        c[mid] = (c[mid] - c[lo]) * sat / (c[hi] - c[lo]);
+        c[hi] = sat;
+    } else {
+        c[mid] = 0.0f;
+        c[hi] = 0.0f;
+    }
+    c[lo] = 0.0f;
+}
+
+static void BlendNonSeparable(int mode, const float cs[3], const float cd[3], float out[3]) {
+    switch (mode) {
+        case FT_COLR_COMPOSITE_HSL_HUE:
+            std::copy(cs, cs + 3, out);
+            SetSat(out, Sat(cd));
+            SetLum(out, Lum(cd));
+            break;
+        case FT_COLR_COMPOSITE_HSL_SATURATION:
+            std::copy(cd, cd + 3, out);
+            SetSat(out, Sat(cs));
+            SetLum(out, Lum(cd));
+            break;
+        case FT_COLR_COMPOSITE_HSL_COLOR:
+            std::copy(cs, cs + 3, out);
+            SetLum(out, Lum(cd));
+            break;
+        default: // FT_COLR_COMPOSITE_HSL_LUMINOSITY
+            std::copy(cd, cd + 3, out);
+            SetLum(out, Lum(cs));
+            break;
+    }
+}
+
+// Composite one premultiplied pixel pair
+static void BlendPixel(int mode, const float s[4], const float d[4], float out[4]) {
+    float sa = s[3];
+    float da = d[3];
+    
+    // Porter-Duff operators: out = s * fa + d * fb
+    float fa, fb;
+    switch (mode) {
+        case FT_COLR_COMPOSITE_CLEAR: fa = 0.0f; fb = 0.0f; break;
+        case FT_COLR_COMPOSITE_SRC: fa = 1.0f; fb = 0.0f; break;
+        case FT_COLR_COMPOSITE_DEST: fa = 0.0f; fb = 1.0f; break;
+        case FT_COLR_COMPOSITE_SRC_OVER: fa = 1.0f; fb = 1.0f - sa; break;
+        case FT_COLR_COMPOSITE_DEST_OVER: fa = 1.0f - da; fb = 1.0f; break;
+        case FT_COLR_COMPOSITE_SRC_IN: fa = da; fb = 0.0f; break;
+        case FT_COLR_COMPOSITE_DEST_IN: fa = 0.0f; fb = sa; break;
+        case FT_COLR_COMPOSITE_SRC_OUT: fa = 1.0f - da; fb = 0.0f; break;
+        case FT_COLR_COMPOSITE_DEST_OUT: fa = 0.0f; fb = 1.0f - sa; break;
+        case FT_COLR_COMPOSITE_SRC_ATOP: fa = da; fb = 1.0f - sa; break;
+        case FT_COLR_COMPOSITE_DEST_ATOP: fa = 1.0f - da; fb = sa; break;
+        case FT_COLR_COMPOSITE_XOR: fa = 1.0f - da; fb = 1.0f - sa; break;
+        case FT_COLR_COMPOSITE_PLUS:
+            for (int i = 0; i < 4; ++i) out[i] = std::min(1.0f, s[i] + d[i]);
+            return;
+        default: {
+            // Blend modes mix the straight colors where both are present
+            float cs[3], cd[3], mixed[3];
+            for (int i = 0; i < 3; ++i) {
+                cs[i] = sa > 0.0f ? s[i] / sa : 0.0f;
+                cd[i] = da > 0.0f ? d[i] / da : 0.0f;
+            }
+            if (mode >= FT_COLR_COMPOSITE_HSL_HUE) {
+                BlendNonSeparable(mode, cs, cd, mixed);
+            } else {
+                for (int i = 0; i < 3; ++i) mixed[i] = BlendChannel(mode, cs[i], cd[i]);
+            }
+            for (int i = 0; i < 3; ++i) {
+                out[i] = s[i] * (1.0f - da) + d[i] * (1.0f - sa) + sa * da * mixed[i];
+            }
+            out[3] = sa + da - sa * da;
+            return;
+        }
+    }
+    
+    for (int i = 0; i < 4; ++i) out[i] = s[i] * fa + d[i] * fb;
+}
+
+ColrPaintRasterizer::Rect ColrPaintRasterizer::Rect::intersect(const Rect& other) const {
+    return {std::max(x0, other.x0), std::max(y0, other.y0), std::min(x1, other.x1), std::min(y1, other.y1)};
+}
+
+ColrPaintRasterizer::Rect ColrPaintRasterizer::Rect::unite(const Rect& other) const {
+    if (empty()) return other;
+    if (other.empty()) return *this;
+    return {std::min(x0, other.x0), std::min(y0, other.y0), std::max(x1, other.x1), std::max(y1, other.y1)};
+}
+
+ColrPaintRasterizer::Affine ColrPaintRasterizer::Affine::concat(const Affine& inner) const {
+    return {
+        xx * inner.xx + xy * inner.yx, xx * inner.xy + xy * inner.yy, xx * inner.dx + xy * inner.dy + dx,
+        yx * inner.xx + yy * inner.yx, yx * inner.xy + yy * inner.yy, yx * inner.dx + yy * inner.dy + dy,
+    };
+}
+
+bool ColrPaintRasterizer::Affine::invert(Affine& inverse) const {
+    float det = xx * yy - xy * yx;
+    if (std::fabs(det) < 1e-12f) {
+        return false;
+    }
+    
+    float inv = 1.0f / det;
+    inverse.xx = yy * inv;
+    inverse.xy = -xy * inv;
+    inverse.yx = -yx * inv;
+    inverse.yy = xx * inv;
+    inverse.dx = -(inverse.xx * dx + inverse.xy * dy);
+    inverse.dy = -(inverse.yx * dx + inverse.yy * dy);
+    return true;
+}
+
+ColrPaintRasterizer::ColrPaintRasterizer(int width, int height)
+    : m_width(width)
+    , m_height(height)
+    , m_library(nullptr)
+    , m_layerCount(0)
+    , m_maskCount(0)
+{
+    m_span.resize(width * 4, 0);
+    m_fullCoverage.resize(width, 255);
+    m_gradient.resize(256 * 4, 0);
+}
+
+bool ColrPaintRasterizer::render(void* ftFace, uint32_t glyphIndex, float scale, float baseline, uint8_t* rgba,
+                                 size_t stride) {
+    FT_Face face = (FT_Face)ftFace;
+    
+    std::shared_ptr<const PaintDisplayList> list = PaintDisplayListCache::get().acquire(face, glyphIndex);
+    if (!list || list->ops.empty()) {
+        return false;
+    }
+    m_library = face->glyph->library;
+    
+    // Font units are y up, the canvas is y down
+    PaintState state;
+    state.transform = {scale, 0.0f, 0.0f, 0.0f, -scale, baseline};
+    state.mask = -1;
+    state.clip = {0, 0, m_width, m_height};
+    
+    m_layerCount = 0;
+    m_maskCount = 0;
+    int layer = acquireLayer();
+    bool drawn = drawOps(*list, 0, static_cast<uint32_t>(list->ops.size()), state, layer);
+    
+    // Hand back straight alpha like the other rendering paths
+    const uint8_t* src = m_layers[layer].pixels.data();
+    for (int y = 0; y < m_height; ++y, rgba += stride) {
+        uint8_t* dst = rgba;
+        for (int x = 0; x < m_width; ++x, src += 4, dst += 4) {
+            uint32_t a = src[3];
+            if (a == 0) {
+                std::memset(dst, 0, 4);
+                continue;
+            }
+            for (int c = 0; c < 3; ++c) {
+                dst[c] = static_cast<uint8_t>(std::min<uint32_t>(255, (src[c] * 255 + a / 2) / a));
+            }
+            dst[3] = static_cast<uint8_t>(a);
+        }
+    }
+    
+    m_layerCount = 0;
+    return drawn;
+}
+
+bool ColrPaintRasterizer::drawOps(const PaintDisplayList& list, uint32_t begin, uint32_t end,
+                                  const PaintState& state, int layer) {
+    bool drawn = false;
+    for (uint32_t i = begin; i < end && !state.clip.empty(); i = list.ops[i].end) {
+        const PaintDisplayList::Op& op = list.ops[i];
+        switch (op.type) {
+            case PaintDisplayList::OP_FILL:
+                drawn |= fillPaint(list, op.data, state, layer);
+                break;
+            
+            case PaintDisplayList::OP_TRANSFORM: {
+                const PaintDisplayList::Transform& t = list.transforms[op.data];
+                PaintState transformed = state;
+                transformed.transform = state.transform.concat({t.xx, t.xy, t.dx, t.yx, t.yy, t.dy});
+                drawn |= drawOps(list, i + 1, op.end, transformed, layer);
+                break;
+            }
+            
+            case PaintDisplayList::OP_CLIP: {
+                int mask = acquireMask();
+                if (rasterizeClip(list, op.data, state, mask)) {
+                    PaintState clipped = state;
+                    clipped.mask = mask;
+                    clipped.clip = m_masks[mask].bounds;
+                    drawn |= drawOps(list, i + 1, op.end, clipped, layer);
+                }
+                --m_maskCount;
+                break;
+            }
+            
+            case PaintDisplayList::OP_COMPOSITE: {
+                // Both sides get their own layer; the result lands on ours
+                int backdrop = acquireLayer();
+                drawOps(list, i + 1, op.data, state, backdrop);
+                int source = acquireLayer();
+                drawOps(list, op.data, op.end, state, source);
+                compositeLayers(source, backdrop, op.mode);
+                drawLayer(backdrop, layer);
+                m_layerCount -= 2;
+                drawn = true;
+                break;
+            }
+            
+            default:
+                break;
+        }
+    }
+    return drawn;
+}
+
+bool ColrPaintRasterizer::fillPaint(const PaintDisplayList& list, uint32_t fillIndex, const PaintState& state,
+                                    int layer) {
+    const PaintDisplayList::Fill& fill = list.fills[fillIndex];
+    const float* g = fill.geometry;
+    const Rect& clip = state.clip;
+    int width = clip.x1 - clip.x0;
+    
+    float tMin = 0.0f, tMax = 0.0f;
+    int extend = fill.extend;
+    
+    // Gradients are evaluated in paint space at pixel centers
+    Affine inverse = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+    if (fill.format == FT_COLR_PAINTFORMAT_SOLID) {
+        // Solid fills reuse one row of source pixels
+        uint8_t pixel[4] = {ToByte(fill.color[0]), ToByte(fill.color[1]), ToByte(fill.color[2]), ToByte(fill.color[3])};
+        for (int x = 0; x < width; ++x) {
+            std::memcpy(&m_span[x * 4], pixel, 4);
+        }
+    } else {
+        // A transform that collapses the plane leaves nothing to see
+        if (!state.transform.invert(inverse)) {
+            return false;
+        }
+        buildGradient(list, fillIndex, tMin, tMax);
+    }
+    
+    // Color line position to premultiplied color, applying the extend mode
+    float tScale = tMax > tMin ? 1.0f / (tMax - tMin) : 0.0f;
+    auto sample = [&](float t, uint8_t* out) {
+        float u = (t - tMin) * tScale;
+        if (extend == FT_COLR_PAINT_EXTEND_REPEAT) {
+            u -= std::floor(u);
+        } else if (extend == FT_COLR_PAINT_EXTEND_REFLECT) {
+            u -= 2.0f * std::floor(u * 0.5f);
+            if (u > 1.0f) u = 2.0f - u;
+        }
+        // NaN lands on the first stop
+        u = u > 0.0f ? (u < 1.0f ? u : 1.0f) : 0.0f;
+        std::memcpy(out, &m_gradient[static_cast<int>(u * 255.0f + 0.5f) * 4], 4);
+    };
+    
+    // Linear: t is the projection onto p0 -> p3, where p3 is p1 moved onto
+    // the line through p0 perpendicular to p0 -> p2
+    float p0x = 0.0f, p0y = 0.0f, dirX = 0.0f, dirY = 0.0f;
+    if (fill.format == FT_COLR_PAINTFORMAT_LINEAR_GRADIENT) {
+        p0x = g[0];
+        p0y = g[1];
+        float v01x = g[2] - p0x;
+        float v01y = g[3] - p0y;
+        float nx = g[5] - p0y;
+        float ny = -(g[4] - p0x);
+        float nn = nx * nx + ny * ny;
+        if (nn > 0.0f) {
+            float k = (v01x * nx + v01y * ny) / nn;
+            dirX = nx * k;
+            dirY = ny * k;
+        } else {
+            dirX = v01x;
+            dirY = v01y;
+        }
+        float length2 = dirX * dirX + dirY * dirY;
+        if (length2 <= 0.0f) {
+            return false;
+        }
+        dirX /= length2;
+        dirY /= length2;
+    }
+    
+    // Radial: two-point conical, circles c0/r0 and c1/r1
+    float c0x = 0.0f, c0y = 0.0f, r0 = 0.0f, cdx = 0.0f, cdy = 0.0f, dr = 0.0f, a = 0.0f;
+    if (fill.format == FT_COLR_PAINTFORMAT_RADIAL_GRADIENT) {
+        c0x = g[0];
+        c0y = g[1];
+        r0 = g[2];
+        cdx = g[3] - c0x;
+        cdy = g[4] - c0y;
+        dr = g[5] - r0;
+        a = cdx * cdx + cdy * cdy - dr * dr;
+    }
+    
+    // Sweep: counter-clockwise from the x axis, in units of 180 degrees
+    float centerX = 0.0f, centerY = 0.0f, startAngle = 0.0f, angleScale = 0.0f;
+    if (fill.format == FT_COLR_PAINTFORMAT_SWEEP_GRADIENT) {
+        centerX = g[0];
+        centerY = g[1];
+        startAngle = g[2] * 180.0f;
+        float endAngle = g[3] * 180.0f;
+        if (endAngle == startAngle) {
+            return false;
+        }
+        angleScale = 1.0f / (endAngle - startAngle);
+    }
+    
+    static const SrcOverSpanFn srcOver = GetSrcOverSpanKernel();
+    Layer& target = m_layers[layer];
+    
+    for (int y = clip.y0; y < clip.y1; ++y) {
+        // Paint-space position of the row's first pixel center and the step
+        // to the next one
+        float px = inverse.xx * (clip.x0 + 0.5f) + inverse.xy * (y + 0.5f) + inverse.dx;
+        float py = inverse.yx * (clip.x0 + 0.5f) + inverse.yy * (y + 0.5f) + inverse.dy;
+        float stepX = inverse.xx;
+        float stepY = inverse.yx;
+        
+        switch (fill.format) {
+            case FT_COLR_PAINTFORMAT_LINEAR_GRADIENT: {
+                // t is linear along the row
+                float t = (px - p0x) * dirX + (py - p0y) * dirY;
+                float dt = stepX * dirX + stepY * dirY;
+                for (int x = 0; x < width; ++x, t += dt) {
+                    sample(t, &m_span[x * 4]);
+                }
+                break;
+            }
+            
+            case FT_COLR_PAINTFORMAT_RADIAL_GRADIENT:
+                for (int x = 0; x < width; ++x, px += stepX, py += stepY) {
+                    // Largest t whose circle passes through the point with r >= 0
+                    float pdx = px - c0x;
+                    float pdy = py - c0y;
+                    float b = pdx * cdx + pdy * cdy + r0 * dr;
+                    float c = pdx * pdx + pdy * pdy - r0 * r0;
+                    float t;
+                    bool covered = false;
+                    if (std::fabs(a) < 1e-6f) {
+                        if (b != 0.0f) {
+                            t = c / (2.0f * b);
+                            covered = r0 + t * dr >= 0.0f;
+                        }
+                    } else {
+                        float disc = b * b - a * c;
+                        if (disc >= 0.0f) {
+                            float root = std::sqrt(disc);
+                            float t1 = (b + root) / a;
+                            float t2 = (b - root) / a;
+                            t = std::max(t1, t2);
+                            covered = r0 + t * dr >= 0.0f;
+                            if (!covered) {
+                                t = std::min(t1, t2);
+                                covered = r0 + t * dr >= 0.0f;
+                            }
+                        }
+                    }
+                    if (covered) {
+                        sample(t, &m_span[x * 4]);
+                    } else {
+                        std::memset(&m_span[x * 4], 0, 4);
+                    }
+                }
+                break;
+            
+            case FT_COLR_PAINTFORMAT_SWEEP_GRADIENT:
+                for (int x = 0; x < width; ++x, px += stepX, py += stepY) {
+                    float angle = std::atan2(py - centerY, px - centerX) * (180.0f / PI);
+                    if (angle < 0.0f) angle += 360.0f;
+                    sample((angle - startAngle) * angleScale, &m_span[x * 4]);
+                }
+                break;
+            
+            default:
+                break;
+        }
+        
+        const uint8_t* coverage = state.mask >= 0
+            ? &m_masks[state.mask].coverage[static_cast<size_t>(y) * m_width + clip.x0]
+            : m_fullCoverage.data();
+        srcOver(&target.pixels[(static_cast<size_t>(y) * m_width + clip.x0) * 4], m_span.data(), coverage, width);
+    }
+    
+    target.dirty = target.dirty.unite(clip);
+    return true;
+}
+
+void ColrPaintRasterizer::compositeLayers(int sourceIndex, int backdropIndex, int mode) {
+    if (mode == FT_COLR_COMPOSITE_SRC_OVER) {
+        drawLayer(sourceIndex, backdropIndex);
+        return;
+    }
+    
+    const Layer& source = m_layers[sourceIndex];
+    Layer& backdrop = m_layers[backdropIndex];
+    
+    // Outside both layers every mode leaves transparent pixels
+    Rect area = source.dirty.unite(backdrop.dirty);
+    for (int y = area.y0; y < area.y1; ++y) {
+        size_t row = (static_cast<size_t>(y) * m_width + area.x0) * 4;
+        const uint8_t* s = &source.pixels[row];
+        uint8_t* d = &backdrop.pixels[row];
+        
+        for (int x = area.x0; x < area.x1; ++x, s += 4, d += 4) {
+            float sf[4], df[4], out[4];
+            for (int c = 0; c < 4; ++c) {
+                sf[c] = s[c] / 255.0f;
+                df[c] = d[c] / 255.0f;
+            }
+            BlendPixel(mode, sf, df, out);
+            
+            // Keep the result premultiplied
+            d[3] = ToByte(out[3]);
+            for (int c = 0; c < 3; ++c) {
+                d[c] = std::min(ToByte(out[c]), d[3]);
+            }
+        }
+    }
+    backdrop.dirty = area;
+}
+
+void ColrPaintRasterizer::drawLayer(int sourceIndex, int targetIndex) {
+    static const SrcOverSpanFn srcOver = GetSrcOverSpanKernel();
+    
+    const Layer& source = m_layers[sourceIndex];
+    Layer& target = m_layers[targetIndex];
+    const Rect& area = source.dirty;
+    if (area.empty()) {
+        return;
+    }
+    
+    for (int y = area.y0; y < area.y1; ++y) {
+        size_t row = (static_cast<size_t>(y) * m_width + area.x0) * 4;
+        srcOver(&target.pixels[row], &source.pixels[row], m_fullCoverage.data(), area.x1 - area.x0);
+    }
+    target.dirty = target.dirty.unite(area);
+}
+
+bool ColrPaintRasterizer::rasterizeClip(const PaintDisplayList& list, uint32_t outlineIndex, const PaintState& state,
+                                        int maskIndex) {
+    const PaintDisplayList::Outline& source = list.outlines[outlineIndex];
+    
+    // The list's points are in font units; the transform takes them to the
+    // canvas in 26.6. Canvas y runs down; FT_Outline_Get_Bitmap's y runs up
+    // from the last row.
+    static_assert(sizeof(FT_Vector) == 2 * sizeof(long), "FT_Pos is a long");
+    m_outlinePoints.resize(static_cast<size_t>(source.pointCount) * 2);
+    const float* points = &list.points[static_cast<size_t>(source.firstPoint) * 2];
+    const Affine& m = state.transform;
+    for (uint32_t i = 0; i < source.pointCount; ++i) {
+        float x = points[i * 2];
+        float y = points[i * 2 + 1];
+        float canvasX = std::clamp(m.xx * x + m.xy * y + m.dx, -32768.0f, 32768.0f);
+        float canvasY = std::clamp(m.yx * x + m.yy * y + m.dy, -32768.0f, 32768.0f);
+        m_outlinePoints[i * 2] = std::lround(canvasX * 64.0f);
+        m_outlinePoints[i * 2 + 1] = std::lround((m_height - canvasY) * 64.0f);
+    }
+    
+    // FreeType only reads the tags and contours
+    FT_Outline outline;
+    outline.n_points = static_cast<decltype(outline.n_points)>(source.pointCount);
+    outline.n_contours = static_cast<decltype(outline.n_contours)>(source.contourCount);
+    outline.points = (FT_Vector*)m_outlinePoints.data();
+    outline.tags = (decltype(outline.tags))&list.tags[source.firstPoint];
+    outline.contours = (decltype(outline.contours))&list.contours[source.firstContour];
+    outline.flags = source.flags;
+    
+    FT_BBox box;
+    FT_Outline_Get_CBox(&outline, &box);
+    Rect bounds = {
+        static_cast<int>(std::floor(box.xMin / 64.0)),
+        m_height - static_cast<int>(std::ceil(box.yMax / 64.0)),
+        static_cast<int>(std::ceil(box.xMax / 64.0)),
+        m_height - static_cast<int>(std::floor(box.yMin / 64.0)),
+    };
+    bounds = bounds.intersect(state.clip);
+    if (bounds.empty()) {
+        return false;
+    }
+    
+    // The rasterizer only writes covered pixels
+    Mask& mask = m_masks[maskIndex];
+    for (int y = bounds.y0; y < bounds.y1; ++y) {
+        std::memset(&mask.coverage[static_cast<size_t>(y) * m_width + bounds.x0], 0, bounds.x1 - bounds.x0);
+    }
+    
+    FT_Bitmap target;
+    std::memset(&target, 0, sizeof(target));
+    target.rows = static_cast<unsigned int>(m_height);
+    target.width = static_cast<unsigned int>(m_width);
+    target.pitch = m_width;
+    target.buffer = mask.coverage.data();
+    target.num_grays = 256;
+    target.pixel_mode = FT_PIXEL_MODE_GRAY;
+    if (FT_Outline_Get_Bitmap((FT_Library)m_library, &outline, &target) != 0) {
+        return false;
+    }
+    
+    // A clip inside a clip keeps only what both cover
+    if (state.mask >= 0) {
+        const Mask& parent = m_masks[state.mask];
+        for (int y = bounds.y0; y < bounds.y1; ++y) {
+            size_t row = static_cast<size_t>(y) * m_width;
+            for (int x = bounds.x0; x < bounds.x1; ++x) {
+                mask.coverage[row + x] = static_cast<uint8_t>(Div255(mask.coverage[row + x] * parent.coverage[row + x]));
+            }
+        }
+    }
+    
+    mask.bounds = bounds;
+    return true;
+}
+
+void ColrPaintRasterizer::buildGradient(const PaintDisplayList& list, uint32_t fillIndex, float& tMin, float& tMax) {
+    const PaintDisplayList::Fill& fill = list.fills[fillIndex];
+    const float* stops = &list.stops[static_cast<size_t>(fill.firstStop) * 5];
+    size_t count = fill.stopCount;
+    
+    // The lookup table spans the first to the last stop; colors are
+    // interpolated premultiplied
+    tMin = stops[0];
+    tMax = stops[(count - 1) * 5];
+    size_t segment = 0;
+    for (int i = 0; i < 256; ++i) {
+        float t = tMax > tMin ? tMin + (tMax - tMin) * (i / 255.0f) : tMax;
+        while (segment + 1 < count && stops[(segment + 1) * 5] < t) {
+            ++segment;
+        }
+        
+        const float* from = &stops[segment * 5];
+        const float* to = segment + 1 < count ? &stops[(segment + 1) * 5] : from;
+        float span = to[0] - from[0];
+        float f = span > 0.0f ? std::clamp((t - from[0]) / span, 0.0f, 1.0f) : 1.0f;
+        for (int c = 0; c < 4; ++c) {
+            m_gradient[i * 4 + c] = ToByte(from[c + 1] + (to[c + 1] - from[c + 1]) * f);
+        }
+    }
+}
+
+int ColrPaintRasterizer::acquireLayer() {
+    if (m_layerCount == static_cast<int>(m_layers.size())) {
+        Layer layer;
+        layer.pixels.resize(static_cast<size_t>(m_width) * m_height * 4, 0);
+        layer.dirty = {0, 0, 0, 0};
+        m_layers.push_back(std::move(layer));
+    }
+    
+    // Clear whatever the previous user drew
+    Layer& layer = m_layers[m_layerCount];
+    if (!layer.dirty.empty()) {
+        for (int y = layer.dirty.y0; y < layer.dirty.y1; ++y) {
+            std::memset(&layer.pixels[(static_cast<size_t>(y) * m_width + layer.dirty.x0) * 4], 0,
+                        static_cast<size_t>(layer.dirty.x1 - layer.dirty.x0) * 4);
+        }
+    }
+    layer.dirty = {0, 0, 0, 0};
+    return m_layerCount++;
+}
+
+int ColrPaintRasterizer::acquireMask() {
+    if (m_maskCount == static_cast<int>(m_masks.size())) {
+        Mask mask;
+        mask.coverage.resize(static_cast<size_t>(m_width) * m_height, 0);
+        mask.bounds = {0, 0, 0, 0};
+        m_masks.push_back(std::move(mask));
+    }
+    return m_maskCount++;
+}
+
+} // namespace ImBored::UI
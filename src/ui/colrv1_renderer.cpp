@@ -1,13 +1,25 @@
 #include "ui/colrv1_renderer.hpp"
+#include "ui/svg_glyph_table.hpp"
+#include "ui/glyph_cache.hpp"
+#include "ui/composite_kernels.hpp"
+#include "ui/colr_paint_rasterizer.hpp"
+#include "ui/bitmap_resampler.hpp"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
+#include <string>
+
+// LunaSVG for OT-SVG glyphs
+#include <lunasvg.h>
 
 // FreeType headers
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_COLOR_H
 #include FT_GLYPH_H
+#include FT_OUTLINE_H
+#include FT_TRUETYPE_TABLES_H
 
 #ifdef SKIA_AVAILABLE
 #include "include/core/SkCanvas.h"
@@ -17,37 +29,100 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkFontTypes.h"
+#include "include/core/SkTypeface.h"
+#include "include/core/SkFontMgr.h"
+#if defined(_WIN32)
+#include "include/ports/SkTypeface_win.h"
+#elif defined(__APPLE__)
+#include "include/ports/SkFontMgr_mac_ct.h"
+#else
+#include "include/ports/SkFontMgr_fontconfig.h"
+// Newer Skia takes the font scanner explicitly; older packs only have the
+// one-argument constructor and scan with FreeType on their own
+#if __has_include("include/ports/SkFontScanner_FreeType.h")
+#include "include/ports/SkFontScanner_FreeType.h"
+#define IMBORED_SKIA_FONT_SCANNER 1
+#endif
+#endif
+#include <mutex>
 #endif
 
 namespace ImBored::UI {
 
+// A layer being drawn by BlendSpans
+struct SpanTarget {
+    uint8_t* pixels;
+    size_t stride;
+    int width, height;
+    int originX, originY;   // Pixel the raster's (0, 0) stands for
+    uint8_t* coverage;      // One row of scratch
+    CompositeSpanFn composite;
+    const uint8_t* color;
+};
+
+// FT_SpanFunc for direct rendering: each span is a run of pixels with one
+// coverage value, composited into the target as FreeType produces it
+static void BlendSpans(int y, int count, const FT_Span* spans, void* user) {
+    const SpanTarget& target = *static_cast<const SpanTarget*>(user);
+    
+    // Raster rows count up from the baseline, which sits on the bottom row
+    int row = target.height - 1 - (y + target.originY);
+    if (row < 0 || row >= target.height) {
+        return;
+    }
+    uint8_t* line = target.pixels + static_cast<size_t>(row) * target.stride;
+    
+    for (int i = 0; i < count; ++i) {
+        int x = std::max(0, spans[i].x + target.originX);
+        int end = std::min(target.width, spans[i].x + spans[i].len + target.originX);
+        if (x >= end) {
+            continue;
+        }
+        std::memset(target.coverage, spans[i].coverage, end - x);
+        target.composite(line + static_cast<size_t>(x) * 4, target.coverage, end - x, target.color);
+    }
+}
+
 COLRv1Renderer::COLRv1Renderer(int width, int height)
     : m_width(width)
     , m_height(height)
+    , m_svgDocuments(nullptr)
+    , m_glyphCache(nullptr)
+    , m_glyphCacheFace(-1)
+    , m_paintRasterizer(std::make_unique<ColrPaintRasterizer>(width, height))
+    , m_resampler(std::make_unique<BitmapResampler>())
+    , m_target(nullptr)
+    , m_targetStride(static_cast<size_t>(width) * 4)
+    , m_face(nullptr)
+    , m_renderPathCount(0)
+    , m_palette(nullptr)
+    , m_paletteSize(0)
 #ifdef SKIA_AVAILABLE
-    , m_surface(nullptr)
     , m_canvas(nullptr)
 #endif
 {
     m_buffer.resize(width * height * 4, 0);
+    m_scratch.resize(width, 0);
+    m_target = m_buffer.data();
     
 #ifdef SKIA_AVAILABLE
-    // TODO: Initialize Skia surface once API version is confirmed
-    // For now, Skia integration is prepared but not fully active
-    // Falls back to PNG/CBDT + COLR v0 + grayscale rendering
-    std::cout << "COLRv1Renderer: Skia library linked, but initialization disabled pending API verification\n";
-    std::cout << "COLRv1Renderer: Using PNG/CBDT + COLR v0 + grayscale fallback\n";
-#endif
-}
-
-COLRv1Renderer::~COLRv1Renderer() {
-#ifdef SKIA_AVAILABLE
+    // Wrap the buffer itself: m_buffer is never resized after this, so Skia
+    // draws straight into the pixels the atlas reads
+    SkImageInfo info = SkImageInfo::Make(width, height, kRGBA_8888_SkColorType, kPremul_SkAlphaType);
+    m_surface = SkSurfaces::WrapPixels(info, m_buffer.data(), static_cast<size_t>(width) * 4);
     if (m_surface) {
-        delete m_surface;
+        m_canvas = m_surface->getCanvas();
+    } else {
+        std::cerr << "COLRv1Renderer: Failed to create " << width << "x" << height
+                  << " Skia surface, using the built-in rasterizer\n";
     }
 #endif
 }
 
+COLRv1Renderer::~COLRv1Renderer() = default;
+
 bool COLRv1Renderer::isSkiaAvailable() {
 #ifdef SKIA_AVAILABLE
     return true;
@@ -56,120 +131,356 @@ bool COLRv1Renderer::isSkiaAvailable() {
 #endif
 }
 
+uint32_t COLRv1Renderer::getRenderVersion() {
+    // Bump RENDER_VERSION when any rasterization path changes its output
+    constexpr uint32_t RENDER_VERSION = 7;
+    return (RENDER_VERSION << 1) | (isSkiaAvailable() ? 1u : 0u);
+}
+
 void COLRv1Renderer::clear() {
-    std::fill(m_buffer.begin(), m_buffer.end(), 0);
+    for (int row = 0; row < m_height; ++row) {
+        std::memset(getTargetRow(row), 0, static_cast<size_t>(m_width) * 4);
+    }
 }
 
-void COLRv1Renderer::compositeLayer(const std::vector<uint8_t>& layer, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
-    for (size_t i = 0; i < m_buffer.size(); i += 4) {
-        // Get alpha from the layer (grayscale)
-        uint8_t layer_alpha = layer[i + 3];
-        if (layer_alpha == 0) continue;
+bool COLRv1Renderer::compositeLayer(const CachedGlyphBitmap& bitmap, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    if (bitmap.pixelMode != FT_PIXEL_MODE_GRAY && bitmap.pixelMode != FT_PIXEL_MODE_MONO) {
+        return false;
+    }
+    
+    // SIMD kernel for this CPU, chosen on first use
+    static const CompositeSpanFn composite = GetCompositeSpanKernel();
+    const uint8_t color[4] = {r, g, b, a};
+    
+    // Clip the bitmap's box to the buffer
+    int bearingX = bitmap.left;
+    int bearingY = m_height - bitmap.top;
+    int colStart = std::max(0, -bearingX);
+    int colEnd = std::min(bitmap.width, m_width - bearingX);
+    int rowStart = std::max(0, -bearingY);
+    int rowEnd = std::min(bitmap.height, m_height - bearingY);
+    if (colStart >= colEnd || rowStart >= rowEnd) {
+        return true;
+    }
+    size_t spanPixels = static_cast<size_t>(colEnd - colStart);
+    
+    for (int row = rowStart; row < rowEnd; ++row) {
+        const uint8_t* src = bitmap.buffer + row * bitmap.pitch;
+        const uint8_t* coverage = src + colStart;
         
-        // Apply color and composite
-        uint8_t final_alpha = (layer_alpha * a) / 255;
-        uint8_t inv_alpha = 255 - final_alpha;
+        // 1-bit strikes are expanded into the scratch row first
+        if (bitmap.pixelMode == FT_PIXEL_MODE_MONO) {
+            for (int col = colStart; col < colEnd; ++col) {
+                bool set = (src[col >> 3] & (0x80 >> (col & 7))) != 0;
+                m_scratch[col - colStart] = set ? 255 : 0;
+            }
+            coverage = m_scratch.data();
+        }
         
-        m_buffer[i + 0] = (r * final_alpha + m_buffer[i + 0] * inv_alpha) / 255;
-        m_buffer[i + 1] = (g * final_alpha + m_buffer[i + 1] * inv_alpha) / 255;
-        m_buffer[i + 2] = (b * final_alpha + m_buffer[i + 2] * inv_alpha) / 255;
-        m_buffer[i + 3] = std::max(final_alpha, m_buffer[i + 3]);
+        uint8_t* dst = getTargetRow(bearingY + row) + static_cast<size_t>(bearingX + colStart) * 4;
+        composite(dst, coverage, spanPixels, color);
     }
+    
+    return true;
 }
 
-bool COLRv1Renderer::renderPaintLayer(void* ftFace, uint32_t glyphIndex, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& a) {
+bool COLRv1Renderer::compositeOutline(void* ftFace, void* ftOutline, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
     FT_Face face = (FT_Face)ftFace;
+    FT_Outline* outline = (FT_Outline*)ftOutline;
     
-    // Load the glyph
-    FT_Error err = FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT);
-    if (err != 0) {
-        std::cerr << "COLRv1Renderer: Failed to load glyph " << glyphIndex << ", error: " << err << "\n";
+    // SIMD kernel for this CPU, chosen on first use
+    static const CompositeSpanFn composite = GetCompositeSpanKernel();
+    const uint8_t color[4] = {r, g, b, a};
+    
+    SpanTarget target;
+    target.pixels = m_target;
+    target.stride = m_targetStride;
+    target.width = m_width;
+    target.height = m_height;
+    
+    // The gray raster's coverage at negative coordinates differs slightly
+    // from FT_Render_Glyph, which first moves the outline to (0, 0). Do the
+    // same, by whole pixels, so spans match the cached bitmaps exactly.
+    FT_BBox box;
+    FT_Outline_Get_CBox(outline, &box);
+    target.originX = static_cast<int>(box.xMin >> 6);
+    target.originY = static_cast<int>(box.yMin >> 6);
+    target.coverage = m_scratch.data();
+    target.composite = composite;
+    target.color = color;
+    
+    // BlendSpans clips to the target itself
+    FT_Raster_Params params = {};
+    params.source = outline;
+    params.flags = FT_RASTER_FLAG_AA | FT_RASTER_FLAG_DIRECT;
+    params.gray_spans = BlendSpans;
+    params.user = &target;
+    
+    // Cached outlines are shared, so they are moved back afterwards; the
+    // shift is whole pixels and exact
+    FT_Pos shiftX = -static_cast<FT_Pos>(target.originX) * 64;
+    FT_Pos shiftY = -static_cast<FT_Pos>(target.originY) * 64;
+    FT_Outline_Translate(outline, shiftX, shiftY);
+    FT_Error err = FT_Outline_Render(face->glyph->library, outline, &params);
+    FT_Outline_Translate(outline, -shiftX, -shiftY);
+    return err == 0;
+}
+
+bool COLRv1Renderer::renderPaintLayer(void* ftFace, uint32_t glyphIndex, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& a) {
+    CachedGlyphBitmap bitmap;
+    void* outline = nullptr;
+    if (!loadGlyph(ftFace, glyphIndex, FT_LOAD_DEFAULT, bitmap, &outline)) {
+        std::cerr << "COLRv1Renderer: Failed to render glyph " << glyphIndex << "\n";
+        return false;
+    }
+    
+    // Overlapping contours need the 4x oversampling FT_Render_Glyph applies
+    // to them and the span path can't; those load as rendered bitmaps
+    if (outline && (((const FT_Outline*)outline)->flags & FT_OUTLINE_OVERLAP)) {
+        outline = nullptr;
+        if (!loadGlyph(ftFace, glyphIndex, FT_LOAD_DEFAULT | FT_LOAD_RENDER, bitmap)) {
+            std::cerr << "COLRv1Renderer: Failed to render glyph " << glyphIndex << "\n";
+            return false;
+        }
+    }
+    
+    // Outlines go straight to the target; only bitmaps the font or the
+    // glyph cache already has are composited from memory
+    if (outline) {
+        if (((const FT_Outline*)outline)->n_points == 0) {
+            std::cerr << "COLRv1Renderer: Glyph " << glyphIndex << " has empty outline\n";
+            return false;
+        }
+        return compositeOutline(ftFace, outline, r, g, b, a);
+    }
+    
+    if (bitmap.width == 0 || bitmap.height == 0) {
+        std::cerr << "COLRv1Renderer: Glyph " << glyphIndex << " has empty bitmap\n";
+        return false;
+    }
+    
+    // Composite straight from the glyph's bitmap, no full-canvas layer
+    if (!compositeLayer(bitmap, r, g, b, a)) {
+        std::cerr << "COLRv1Renderer: Glyph " << glyphIndex << " has unsupported pixel mode " << bitmap.pixelMode << "\n";
         return false;
     }
     
-    // Try to render the glyph
-    err = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+    return true;
+}
+
+bool COLRv1Renderer::loadGlyph(void* ftFace, uint32_t glyphIndex, int32_t loadFlags, CachedGlyphBitmap& bitmap,
+                               void** outline) {
+    FT_Face face = (FT_Face)ftFace;
+    
+    // The caller configured the face's size (strike or scaled); the cache
+    // looks glyphs up at the same pixel size on its own face
+    if (m_glyphCache && face->size) {
+        const FT_Size_Metrics& metrics = face->size->metrics;
+        return m_glyphCache->lookupGlyph(m_glyphCacheFace, metrics.x_ppem, metrics.y_ppem, glyphIndex, loadFlags,
+                                         bitmap, outline);
+    }
+    
+    FT_Error err = FT_Load_Glyph(face, glyphIndex, loadFlags);
     if (err != 0) {
-        std::cerr << "COLRv1Renderer: Failed to render glyph " << glyphIndex << ", error: " << err << "\n";
         return false;
     }
     
-    FT_Bitmap& bitmap = face->glyph->bitmap;
-    if (bitmap.width == 0 || bitmap.rows == 0) {
-        std::cerr << "COLRv1Renderer: Glyph " << glyphIndex << " has empty bitmap\n";
+    FT_GlyphSlot slot = face->glyph;
+    if (slot->format == FT_GLYPH_FORMAT_OUTLINE) {
+        if (!outline) {
+            return false;
+        }
+        *outline = &slot->outline;
+        return true;
+    }
+    if (slot->format != FT_GLYPH_FORMAT_BITMAP) {
         return false;
     }
     
-    // Create a layer buffer
-    std::vector<uint8_t> layer_buffer(m_width * m_height * 4, 0);
+    bitmap.buffer = slot->bitmap.buffer;
+    bitmap.width = static_cast<int>(slot->bitmap.width);
+    bitmap.height = static_cast<int>(slot->bitmap.rows);
+    bitmap.pitch = slot->bitmap.pitch;
+    bitmap.left = slot->bitmap_left;
+    bitmap.top = slot->bitmap_top;
+    bitmap.pixelMode = slot->bitmap.pixel_mode;
+    return true;
+}
+
+uint32_t COLRv1Renderer::detectColorFormats(void* ftFace) {
+    FT_Face face = (FT_Face)ftFace;
+    if (!FT_IS_SFNT(face)) {
+        return 0;
+    }
+    
+    // A null buffer only asks for the table's length
+    auto hasTable = [face](FT_ULong tag) {
+        FT_ULong length = 0;
+        return FT_Load_Sfnt_Table(face, tag, 0, nullptr, &length) == 0 && length > 0;
+    };
     
-    // Copy bitmap to layer buffer
-    int bearingX = face->glyph->bitmap_left;
-    int bearingY = m_height - face->glyph->bitmap_top;
+    uint32_t formats = 0;
+    if (hasTable(FT_MAKE_TAG('C', 'B', 'D', 'T')) && hasTable(FT_MAKE_TAG('C', 'B', 'L', 'C'))) {
+        formats |= COLOR_FORMAT_CBDT;
+    }
+    if (hasTable(FT_MAKE_TAG('s', 'b', 'i', 'x'))) {
+        formats |= COLOR_FORMAT_SBIX;
+    }
+    if (hasTable(FT_MAKE_TAG('S', 'V', 'G', ' '))) {
+        formats |= COLOR_FORMAT_SVG;
+    }
     
-    for (unsigned int row = 0; row < bitmap.rows; ++row) {
-        int dest_y = bearingY + row;
-        if (dest_y < 0 || dest_y >= m_height) continue;
-        
-        for (unsigned int col = 0; col < bitmap.width; ++col) {
-            int dest_x = bearingX + col;
-            if (dest_x < 0 || dest_x >= m_width) continue;
-            
-            int bufferIdx = (dest_y * m_width + dest_x) * 4;
-            int bitmapIdx = row * bitmap.pitch + col;
-            
-            uint8_t gray = bitmap.buffer[bitmapIdx];
-            layer_buffer[bufferIdx + 0] = gray;
-            layer_buffer[bufferIdx + 1] = gray;
-            layer_buffer[bufferIdx + 2] = gray;
-            layer_buffer[bufferIdx + 3] = gray;
+    // COLR header: uint16 version, uint16 numBaseGlyphRecords. Version 1
+    // tables can still hold v0 layer glyphs.
+    FT_Byte header[4];
+    FT_ULong length = sizeof(header);
+    if (hasTable(FT_MAKE_TAG('C', 'P', 'A', 'L')) &&
+        FT_Load_Sfnt_Table(face, FT_MAKE_TAG('C', 'O', 'L', 'R'), 0, header, &length) == 0) {
+        uint16_t version = static_cast<uint16_t>((header[0] << 8) | header[1]);
+        uint16_t baseGlyphs = static_cast<uint16_t>((header[2] << 8) | header[3]);
+        if (baseGlyphs > 0) {
+            formats |= COLOR_FORMAT_COLR_V0;
+        }
+        if (version >= 1) {
+            formats |= COLOR_FORMAT_COLR_V1;
         }
     }
     
-    // Composite the layer
-    compositeLayer(layer_buffer, r, g, b, a);
+    return formats;
+}
+
+std::string COLRv1Renderer::describeColorFormats(uint32_t formats) {
+    static const struct {
+        uint32_t format;
+        const char* name;
+    } names[] = {
+        {COLOR_FORMAT_CBDT, "CBDT"},
+        {COLOR_FORMAT_SBIX, "sbix"},
+        {COLOR_FORMAT_COLR_V0, "COLRv0"},
+        {COLOR_FORMAT_COLR_V1, "COLRv1"},
+        {COLOR_FORMAT_SVG, "SVG"},
+    };
     
-    return true;
+    std::string description;
+    for (const auto& entry : names) {
+        if (formats & entry.format) {
+            if (!description.empty()) description += ' ';
+            description += entry.name;
+        }
+    }
+    return description.empty() ? "none" : description;
 }
 
-bool COLRv1Renderer::renderGlyph(void* ftFace, uint32_t glyphIndex, uint32_t codepoint) {
+void COLRv1Renderer::selectRenderPaths(void* ftFace) {
     FT_Face face = (FT_Face)ftFace;
+    uint32_t formats = detectColorFormats(ftFace);
     
-    // Clear buffer
-    clear();
+    m_face = face;
+    m_palette = nullptr;
+    m_paletteSize = 0;
+    FT_Palette_Data paletteData;
+    FT_Color* palette = nullptr;
+    if ((formats & (COLOR_FORMAT_COLR_V0 | COLOR_FORMAT_COLR_V1)) &&
+        FT_Palette_Data_Get(face, &paletteData) == 0 && FT_Palette_Select(face, 0, &palette) == 0) {
+        m_palette = palette;
+        m_paletteSize = paletteData.num_palette_entries;
+    }
     
+    // Same precedence as fonts that carry several formats expect: vector
+    // paint graphs and SVG over bitmaps, bitmaps over flat layers
+    m_renderPathCount = 0;
+    auto add = [this](RenderFn fn) { m_renderPaths[m_renderPathCount++] = fn; };
 #ifdef SKIA_AVAILABLE
-    // Try Skia rendering first if available
-    if (m_canvas && renderWithSkia(ftFace, glyphIndex, codepoint)) {
-        return true;
+    if ((formats & COLOR_FORMAT_COLR_V1) && m_canvas) {
+        add(&COLRv1Renderer::renderWithSkia);
     }
 #endif
+    if ((formats & COLOR_FORMAT_SVG) && m_svgDocuments) {
+        add(&COLRv1Renderer::renderSvgGlyph);
+    }
+    if (formats & (COLOR_FORMAT_CBDT | COLOR_FORMAT_SBIX)) {
+        add(&COLRv1Renderer::renderBitmapStrike);
+    }
+    if (formats & COLOR_FORMAT_COLR_V1) {
+        add(&COLRv1Renderer::renderPaintGraph);
+    }
+    if (formats & COLOR_FORMAT_COLR_V0) {
+        add(&COLRv1Renderer::renderColorLayers);
+    }
+    add(&COLRv1Renderer::renderGrayscale);
+}
+
+bool COLRv1Renderer::renderGlyph(void* ftFace, uint32_t glyphIndex) {
+    // Renderers serve one face; probing again only if that changes
+    if (ftFace != m_face) {
+        selectRenderPaths(ftFace);
+    }
+    return renderTarget(ftFace, glyphIndex);
+}
+
+size_t COLRv1Renderer::renderGlyphs(void* ftFace, std::span<GlyphRequest> requests, const AtlasView& view) {
+    if (ftFace != m_face) {
+        selectRenderPaths(ftFace);
+    }
     
-    // Try to render PNG/CBDT bitmap strikes (embedded color bitmaps)
-    if (renderBitmapStrike(ftFace, glyphIndex, codepoint)) {
-        return true;
+    // Ascending glyph ids keep FreeType's reads moving forward through the
+    // font's tables and the glyph cache's buckets warm
+    m_order.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        m_order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(m_order.begin(), m_order.end(), [&](uint32_t a, uint32_t b) {
+        return requests[a].glyphIndex < requests[b].glyphIndex;
+    });
+    
+    size_t rendered = 0;
+    for (uint32_t i : m_order) {
+        GlyphRequest& request = requests[i];
+        request.rendered = false;
+        if (request.x < 0 || request.y < 0 || request.x + m_width > view.width || request.y + m_height > view.height) {
+            continue;
+        }
+        
+        m_target = view.pixels + static_cast<size_t>(request.y) * view.stride + static_cast<size_t>(request.x) * 4;
+        m_targetStride = view.stride;
+        request.rendered = renderTarget(ftFace, request.glyphIndex);
+        if (request.rendered) {
+            rendered++;
+        }
     }
     
-    // Fallback to basic COLR v0 rendering
-    // Try COLR v0 first (layered rendering)
+    m_target = m_buffer.data();
+    m_targetStride = static_cast<size_t>(m_width) * 4;
+    return rendered;
+}
+
+bool COLRv1Renderer::renderTarget(void* ftFace, uint32_t glyphIndex) {
+    clear();
+    
+    for (int i = 0; i < m_renderPathCount; ++i) {
+        if ((this->*m_renderPaths[i])(ftFace, glyphIndex)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool COLRv1Renderer::renderColorLayers(void* ftFace, uint32_t glyphIndex) {
+    FT_Face face = (FT_Face)ftFace;
+    const FT_Color* palette = (const FT_Color*)m_palette;
+    
     FT_LayerIterator iterator;
     iterator.p = nullptr;
     FT_UInt layer_glyph_index;
     FT_UInt layer_color_index;
     
-    // Get palette
-    FT_Color* palette = nullptr;
-    if (FT_Palette_Select(face, 0, &palette) != 0) {
-        palette = nullptr;
-    }
-    
     bool has_layers = false;
     while (FT_Get_Color_Glyph_Layer(face, glyphIndex, &layer_glyph_index, &layer_color_index, &iterator)) {
         has_layers = true;
         
         // Get color for this layer
         uint8_t r = 0, g = 0, b = 0, a = 255;
-        if (layer_color_index != 0xFFFF && palette != nullptr) {
+        if (layer_color_index != 0xFFFF && palette != nullptr && layer_color_index < m_paletteSize) {
             FT_Color color = palette[layer_color_index];
             r = color.red;
             g = color.green;
@@ -181,88 +492,254 @@ bool COLRv1Renderer::renderGlyph(void* ftFace, uint32_t glyphIndex, uint32_t cod
         renderPaintLayer(ftFace, layer_glyph_index, r, g, b, a);
     }
     
-    if (has_layers) {
-        return true;
+    return has_layers;
+}
+
+bool COLRv1Renderer::renderGrayscale(void* ftFace, uint32_t glyphIndex) {
+    uint8_t r = 128, g = 128, b = 128, a = 255;
+    return renderPaintLayer(ftFace, glyphIndex, r, g, b, a);
+}
+
+#ifdef SKIA_AVAILABLE
+// One font manager for the process, created on the first COLRv1 glyph:
+// making one scans the system fonts
+static SkFontMgr* SharedFontMgr() {
+    static const sk_sp<SkFontMgr> fontMgr = [] {
+#if defined(_WIN32)
+        sk_sp<SkFontMgr> mgr = SkFontMgr_New_DirectWrite();
+#elif defined(__APPLE__)
+        sk_sp<SkFontMgr> mgr = SkFontMgr_New_CoreText(nullptr);
+#elif defined(IMBORED_SKIA_FONT_SCANNER)
+        sk_sp<SkFontMgr> mgr = SkFontMgr_New_FontConfig(nullptr, SkFontScanner_Make_FreeType());
+#else
+        sk_sp<SkFontMgr> mgr = SkFontMgr_New_FontConfig(nullptr);
+#endif
+        if (!mgr) {
+            std::cerr << "COLRv1Renderer: No Skia font manager, using the built-in rasterizer\n";
+        }
+        return mgr;
+    }();
+    return fontMgr.get();
+}
+
+// Typefaces over the same bytes as the FreeType faces they were made for,
+// shared by every renderer so each font blob is parsed by Skia once
+struct SkiaTypefaceCache {
+    struct Entry {
+        const void* data;
+        long faceIndex;
+        sk_sp<SkTypeface> typeface;
+    };
+    std::mutex mutex;
+    std::vector<Entry> entries;
+};
+
+// Typeface for a FreeType memory face, nullptr if Skia can't load it
+static SkTypeface* GetSkiaTypeface(FT_Face face) {
+    static SkiaTypefaceCache cache;
+    
+    // Faces come from FontBlobRegistry, so the stream is the mapped file and
+    // outlives both the face and the typeface
+    const void* data = face->stream ? face->stream->base : nullptr;
+    if (data == nullptr) {
+        return nullptr;
     }
     
-    // For COLRv1 or no color layers: render the base glyph in grayscale
-    // COLRv1 requires complex paint rendering with Skia
-    uint8_t r = 128, g = 128, b = 128, a = 255;
-    bool rendered = renderPaintLayer(ftFace, glyphIndex, r, g, b, a);
+    std::lock_guard<std::mutex> lock(cache.mutex);
     
-    return rendered;
+    for (const SkiaTypefaceCache::Entry& entry : cache.entries) {
+        if (entry.data == data && entry.faceIndex == face->face_index) {
+            return entry.typeface.get();
+        }
+    }
+    
+    sk_sp<SkTypeface> typeface;
+    if (SkFontMgr* fontMgr = SharedFontMgr()) {
+        sk_sp<SkData> bytes = SkData::MakeWithoutCopy(data, face->stream->size);
+        typeface = fontMgr->makeFromData(std::move(bytes), static_cast<int>(face->face_index));
+        if (!typeface) {
+            std::cerr << "COLRv1Renderer: Skia could not load " << (face->family_name ? face->family_name : "font")
+                      << ", using the built-in rasterizer for it\n";
+        }
+    }
+    
+    // Failures are remembered too so the font isn't parsed again per glyph.
+    // Entries live as long as the mapped blobs, i.e. the whole process.
+    cache.entries.push_back({data, face->face_index, typeface});
+    return cache.entries.back().typeface.get();
 }
 
-#ifdef SKIA_AVAILABLE
-bool COLRv1Renderer::renderWithSkia(void* ftFace, uint32_t glyphIndex, uint32_t codepoint) {
-    // Skia library is linked but surface initialization is disabled pending API verification
-    // Different Skia versions have different surface creation APIs
-    // TODO: Match Skia API version and enable surface creation
-    // For now, return false to use PNG/CBDT + COLR v0 + grayscale fallback
+bool COLRv1Renderer::renderWithSkia(void* ftFace, uint32_t glyphIndex) {
+    FT_Face face = (FT_Face)ftFace;
     
-    return false;
+    // Only COLRv1 glyphs; SVG, bitmap strikes and COLR v0 keep their paths
+    FT_OpaquePaint root;
+    root.p = nullptr;
+    if (!FT_Get_Color_Glyph_Paint(face, glyphIndex, FT_COLOR_INCLUDE_ROOT_TRANSFORM, &root)) {
+        return false;
+    }
+    
+    float scale, baseline;
+    if (!getEmPlacement(ftFace, scale, baseline)) {
+        return false;
+    }
+    
+    SkTypeface* typeface = GetSkiaTypeface(face);
+    if (typeface == nullptr) {
+        return false;
+    }
+    
+    SkFont font(sk_ref_sp(typeface), scale * face->units_per_EM);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setHinting(SkFontHinting::kNone);
+    font.setSubpixel(true);
+    
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    
+    // renderGlyph cleared the buffer when it is the target; batch cells were
+    // cleared instead and the surface still holds the previous glyph
+    if (m_target != m_buffer.data()) {
+        m_canvas->clear(SK_ColorTRANSPARENT);
+    }
+    SkGlyphID glyph = static_cast<SkGlyphID>(glyphIndex);
+    m_canvas->drawSimpleText(&glyph, sizeof(glyph), SkTextEncoding::kGlyphID, 0.0f, baseline, font, paint);
+    
+    // The surface is premultiplied; the atlas wants straight alpha. Pixels
+    // land in the target on the way, which is m_buffer itself outside batches.
+    bool drawn = false;
+    for (int row = 0; row < m_height; ++row) {
+        const uint8_t* src = m_buffer.data() + static_cast<size_t>(row) * m_width * 4;
+        uint8_t* dst = getTargetRow(row);
+        for (int col = 0; col < m_width; ++col, src += 4, dst += 4) {
+            uint8_t a = src[3];
+            if (a == 0) {
+                continue;
+            }
+            drawn = true;
+            for (int c = 0; c < 3; ++c) {
+                dst[c] = a == 255 ? src[c] : static_cast<uint8_t>(std::min(255, (src[c] * 255 + a / 2) / a));
+            }
+            dst[3] = a;
+        }
+    }
+    return drawn;
 }
 #endif
 
-bool COLRv1Renderer::renderBitmapStrike(void* ftFace, uint32_t glyphIndex, uint32_t codepoint) {
+bool COLRv1Renderer::getEmPlacement(void* ftFace, float& scale, float& baseline) const {
     FT_Face face = (FT_Face)ftFace;
+    if (face->units_per_EM == 0) {
+        return false;
+    }
     
-    // Check if face has bitmap strikes (CBDT/CBLC or sbix tables)
-    if (!(face->face_flags & FT_FACE_FLAG_COLOR)) {
+    // Map the em to the buffer height and split the rest between ascender
+    // and descender like the font does
+    scale = static_cast<float>(m_height) / face->units_per_EM;
+    float extent = static_cast<float>(face->ascender - face->descender);
+    baseline = extent > 0.0f ? m_height * face->ascender / extent : static_cast<float>(m_height);
+    return true;
+}
+
+bool COLRv1Renderer::renderPaintGraph(void* ftFace, uint32_t glyphIndex) {
+    float scale, baseline;
+    if (!getEmPlacement(ftFace, scale, baseline)) {
         return false;
     }
+    return m_paintRasterizer->render(ftFace, glyphIndex, scale, baseline, m_target, m_targetStride);
+}
+
+bool COLRv1Renderer::renderSvgGlyph(void* ftFace, uint32_t glyphIndex) {
+    FT_Face face = (FT_Face)ftFace;
     
-    // Try to load the glyph with color bitmaps enabled
-    FT_Error err = FT_Load_Glyph(face, glyphIndex, FT_LOAD_COLOR);
-    if (err != 0) {
+    const SvgDocumentRange* range = nullptr;
+    lunasvg::Document* document = m_svgDocuments->getDocument(glyphIndex, &range);
+    float scale, baseline;
+    if (!document || !getEmPlacement(face, scale, baseline)) {
         return false;
     }
     
-    FT_GlyphSlot slot = face->glyph;
+    // OT-SVG draws in font units with y pointing down from the baseline
+    lunasvg::Matrix matrix(scale, 0, 0, scale, 0, baseline);
     
-    // Check if we got a bitmap
-    if (slot->format != FT_GLYPH_FORMAT_BITMAP) {
+    // LunaSVG draws premultiplied ARGB straight into the target
+    lunasvg::Bitmap bitmap(m_target, m_width, m_height, static_cast<int>(m_targetStride));
+    if (range->startGlyph == range->endGlyph) {
+        document->render(bitmap, matrix);
+    } else {
+        // Shared documents name each glyph's element "glyph<id>"
+        lunasvg::Element element = document->getElementById("glyph" + std::to_string(glyphIndex));
+        if (element.isNull()) {
+            return false;
+        }
+        element.render(bitmap, matrix);
+    }
+    bitmap.convertToRGBA();
+    
+    return true;
+}
+
+bool COLRv1Renderer::renderBitmapStrike(void* ftFace, uint32_t glyphIndex) {
+    FT_Face face = (FT_Face)ftFace;
+    
+    // Try to load the glyph with color bitmaps enabled
+    CachedGlyphBitmap bitmap;
+    if (!loadGlyph(ftFace, glyphIndex, FT_LOAD_COLOR, bitmap)) {
         return false;
     }
     
-    FT_Bitmap& bitmap = slot->bitmap;
-    if (bitmap.width == 0 || bitmap.rows == 0) {
+    if (bitmap.width == 0 || bitmap.height == 0) {
         return false;
     }
     
     // Check if it's a color bitmap (BGRA format)
-    if (bitmap.pixel_mode != FT_PIXEL_MODE_BGRA) {
+    if (bitmap.pixelMode != FT_PIXEL_MODE_BGRA) {
         return false;
     }
     
-    // Copy the BGRA bitmap to our buffer
-    int bearingX = slot->bitmap_left;
-    int bearingY = m_height - slot->bitmap_top;
+    // Strikes only come in a few sizes (NotoColorEmoji has one, 109 ppem
+    // with 136 px wide glyphs). Fit the strike's line box and widest
+    // advance into the buffer, and the glyph itself should it stick out.
+    const FT_Size_Metrics& metrics = face->size->metrics;
+    float lineHeight = (metrics.ascender - metrics.descender) / 64.0f;
+    float advance = metrics.max_advance / 64.0f;
+    float scale = std::min({1.0f, static_cast<float>(m_width) / bitmap.width,
+                            static_cast<float>(m_height) / bitmap.height});
+    if (lineHeight > 0.0f) scale = std::min(scale, m_height / lineHeight);
+    if (advance > 0.0f) scale = std::min(scale, m_width / advance);
+    
+    const uint8_t* pixels = bitmap.buffer;
+    int width = bitmap.width;
+    int height = bitmap.height;
+    int pitch = bitmap.pitch;
+    if (scale < 1.0f) {
+        width = std::max(1, static_cast<int>(std::lround(bitmap.width * scale)));
+        height = std::max(1, static_cast<int>(std::lround(bitmap.height * scale)));
+        m_strike.resize(static_cast<size_t>(width) * height * 4);
+        m_resampler->downscale(bitmap.buffer, bitmap.width, bitmap.height, bitmap.pitch, m_strike.data(), width, height);
+        pixels = m_strike.data();
+        pitch = width * 4;
+    }
     
-    for (unsigned int row = 0; row < bitmap.rows; ++row) {
-        int dest_y = bearingY + row;
-        if (dest_y < 0 || dest_y >= m_height) continue;
+    // Baseline where the strike's descender reaches the bottom of the buffer
+    float descender = lineHeight > 0.0f ? -metrics.descender / 64.0f : 0.0f;
+    int bearingX = static_cast<int>(std::lround(bitmap.left * scale));
+    int bearingY = static_cast<int>(std::lround(m_height - descender * scale - bitmap.top * scale));
+    bearingX = std::clamp(bearingX, 0, std::max(0, m_width - width));
+    bearingY = std::clamp(bearingY, 0, std::max(0, m_height - height));
+    
+    for (int row = 0; row < height && bearingY + row < m_height; ++row) {
+        const uint8_t* src = pixels + static_cast<size_t>(row) * pitch;
+        uint8_t* dst = getTargetRow(bearingY + row) + static_cast<size_t>(bearingX) * 4;
         
-        for (unsigned int col = 0; col < bitmap.width; ++col) {
-            int dest_x = bearingX + col;
-            if (dest_x < 0 || dest_x >= m_width) continue;
-            
-            int bufferIdx = (dest_y * m_width + dest_x) * 4;
-            int bitmapIdx = (row * bitmap.pitch) + (col * 4);
-            
-            // BGRA -> RGBA conversion
-            uint8_t b = bitmap.buffer[bitmapIdx + 0];
-            uint8_t g = bitmap.buffer[bitmapIdx + 1];
-            uint8_t r = bitmap.buffer[bitmapIdx + 2];
-            uint8_t a = bitmap.buffer[bitmapIdx + 3];
-            
-            // Pre-multiplied alpha blending
-            if (a > 0) {
-                m_buffer[bufferIdx + 0] = r;
-                m_buffer[bufferIdx + 1] = g;
-                m_buffer[bufferIdx + 2] = b;
-                m_buffer[bufferIdx + 3] = a;
-            }
+        for (int col = 0; col < width && bearingX + col < m_width; ++col, src += 4, dst += 4) {
+            // Premultiplied BGRA to straight RGBA
+            uint32_t a = src[3];
+            if (a == 0) continue;
+            dst[0] = static_cast<uint8_t>(std::min<uint32_t>(255, (src[2] * 255 + a / 2) / a));
+            dst[1] = static_cast<uint8_t>(std::min<uint32_t>(255, (src[1] * 255 + a / 2) / a));
+            dst[2] = static_cast<uint8_t>(std::min<uint32_t>(255, (src[0] * 255 + a / 2) / a));
+            dst[3] = static_cast<uint8_t>(a);
         }
     }
     
@@ -0,0 +1,435 @@
+#include "ui/composite_kernels.hpp"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMBORED_COMPOSITE_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define IMBORED_COMPOSITE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions marked for it;
+// MSVC emits them anywhere
+#if defined(IMBORED_COMPOSITE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define IMBORED_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define IMBORED_TARGET_AVX2
+#endif
+
+namespace ImBored::UI {
+
+// x / 255 rounded to nearest, exact for x <= 255 * 255
+static inline uint32_t Div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+void CompositeSpanScalar(uint8_t* dst, const uint8_t* coverage, size_t pixels, const uint8_t color[4]) {
+    for (size_t i = 0; i < pixels; ++i, dst += 4) {
+        // No coverage leaves the pixel exactly as it was
+        uint32_t cov = coverage[i];
+        if (cov == 0) continue;
+        
+        uint32_t fa = Div255(cov * color[3]);
+        uint32_t inv = 255 - fa;
+        
+        dst[0] = static_cast<uint8_t>(Div255(color[0] * fa + dst[0] * inv));
+        dst[1] = static_cast<uint8_t>(Div255(color[1] * fa + dst[1] * inv));
+        dst[2] = static_cast<uint8_t>(Div255(color[2] * fa + dst[2] * inv));
+        dst[3] = static_cast<uint8_t>(std::max<uint32_t>(fa, dst[3]));
+    }
+}
+
+void SrcOverSpanScalar(uint8_t* dst, const uint8_t* src, const uint8_t* coverage, size_t pixels) {
+    for (size_t i = 0; i < pixels; ++i, dst += 4, src += 4) {
+        uint32_t cov = coverage[i];
+        if (cov == 0) continue;
+        
+        uint32_t sa = Div255(src[3] * cov);
+        uint32_t inv = 255 - sa;
+        
+        // Saturates like the SIMD kernels should a source break premultiplication
+        for (int c = 0; c < 3; ++c) {
+            dst[c] = static_cast<uint8_t>(std::min<uint32_t>(255, Div255(src[c] * cov) + Div255(dst[c] * inv)));
+        }
+        dst[3] = static_cast<uint8_t>(sa + Div255(dst[3] * inv));
+    }
+}
+
+// Bytes [begin, end) of a row filter; the SIMD kernels finish with this
+static void FilterRowsTail(uint8_t* dst, const uint8_t* const* rows, const uint16_t* weights, size_t rowCount,
+                           size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        uint32_t sum = 128;
+        for (size_t k = 0; k < rowCount; ++k) {
+            sum += rows[k][i] * weights[k];
+        }
+        dst[i] = static_cast<uint8_t>(sum >> 8);
+    }
+}
+
+void FilterRowsScalar(uint8_t* dst, const uint8_t* const* rows, const uint16_t* weights, size_t rowCount, size_t bytes) {
+    FilterRowsTail(dst, rows, weights, rowCount, 0, bytes);
+}
+
+#ifdef IMBORED_COMPOSITE_X86
+
+static inline __m128i Div255Sse2(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Two RGBA pixels widened to 16 bits, fa repeated over each pixel's lanes
+static inline __m128i BlendSse2(__m128i dst, __m128i fa, __m128i color, __m128i alphaMask) {
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), fa);
+    __m128i rgb = Div255Sse2(_mm_add_epi16(_mm_mullo_epi16(color, fa), _mm_mullo_epi16(dst, inv)));
+    __m128i alpha = _mm_max_epi16(fa, dst);
+    return _mm_or_si128(_mm_andnot_si128(alphaMask, rgb), _mm_and_si128(alphaMask, alpha));
+}
+
+static void CompositeSpanSse2(uint8_t* dst, const uint8_t* coverage, size_t pixels, const uint8_t color[4]) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i color16 = _mm_set_epi16(color[3], color[2], color[1], color[0],
+                                          color[3], color[2], color[1], color[0]);
+    const __m128i alpha16 = _mm_set1_epi16(color[3]);
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        uint32_t cov32;
+        std::memcpy(&cov32, coverage + i, sizeof(cov32));
+        if (cov32 == 0) continue;
+        
+        __m128i cov = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(cov32)), zero);
+        __m128i fa = Div255Sse2(_mm_mullo_epi16(cov, alpha16));
+        
+        // [f0 f0 f1 f1 f2 f2 f3 f3] -> one pixel's worth of lanes per value
+        __m128i fa2 = _mm_unpacklo_epi16(fa, fa);
+        __m128i faLo = _mm_unpacklo_epi32(fa2, fa2);
+        __m128i faHi = _mm_unpackhi_epi32(fa2, fa2);
+        
+        uint8_t* d = dst + i * 4;
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+        __m128i lo = BlendSse2(_mm_unpacklo_epi8(px, zero), faLo, color16, alphaMask);
+        __m128i hi = BlendSse2(_mm_unpackhi_epi8(px, zero), faHi, color16, alphaMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_packus_epi16(lo, hi));
+    }
+    
+    CompositeSpanScalar(dst + i * 4, coverage + i, pixels - i, color);
+}
+
+// Two premultiplied pixels widened to 16 bits, coverage repeated over each
+// pixel's lanes
+static inline __m128i SrcOverSse2(__m128i dst, __m128i src, __m128i cov) {
+    __m128i s = Div255Sse2(_mm_mullo_epi16(src, cov));
+    __m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i d = Div255Sse2(_mm_mullo_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(255), sa)));
+    return _mm_add_epi16(s, d);
+}
+
+static void SrcOverSpanSse2(uint8_t* dst, const uint8_t* src, const uint8_t* coverage, size_t pixels) {
+    const __m128i zero = _mm_setzero_si128();
+    
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        uint32_t cov32;
+        std::memcpy(&cov32, coverage + i, sizeof(cov32));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        // Transparent source or no coverage leaves dst as it was
+        if (cov32 == 0 || _mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) == 0xFFFF) continue;
+        
+        __m128i cov = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(cov32)), zero);
+        __m128i cov2 = _mm_unpacklo_epi16(cov, cov);
+        
+        uint8_t* d = dst + i * 4;
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+        __m128i lo = SrcOverSse2(_mm_unpacklo_epi8(px, zero), _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi32(cov2, cov2));
+        __m128i hi = SrcOverSse2(_mm_unpackhi_epi8(px, zero), _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi32(cov2, cov2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_packus_epi16(lo, hi));
+    }
+    
+    SrcOverSpanScalar(dst + i * 4, src + i * 4, coverage + i, pixels - i);
+}
+
+// The sums fit in 16 bits: at most 255 * 256 plus the rounding term
+static void FilterRowsSse2(uint8_t* dst, const uint8_t* const* rows, const uint16_t* weights, size_t rowCount,
+                           size_t bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i lo = half;
+        __m128i hi = half;
+        for (size_t k = 0; k < rowCount; ++k) {
+            __m128i w = _mm_set1_epi16(static_cast<short>(weights[k]));
+            __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+            lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), w));
+            hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), w));
+        }
+        __m128i packed = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+    
+    FilterRowsTail(dst, rows, weights, rowCount, i, bytes);
+}
+
+IMBORED_TARGET_AVX2
+static inline __m256i Div255Avx2(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+// Four RGBA pixels widened to 16 bits, fa repeated over each pixel's lanes
+IMBORED_TARGET_AVX2
+static inline __m256i BlendAvx2(__m256i dst, __m256i fa, __m256i color, __m256i alphaMask) {
+    __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), fa);
+    __m256i rgb = Div255Avx2(_mm256_add_epi16(_mm256_mullo_epi16(color, fa), _mm256_mullo_epi16(dst, inv)));
+    __m256i alpha = _mm256_max_epi16(fa, dst);
+    return _mm256_blendv_epi8(rgb, alpha, alphaMask);
+}
+
+IMBORED_TARGET_AVX2
+static void CompositeSpanAvx2(uint8_t* dst, const uint8_t* coverage, size_t pixels, const uint8_t color[4]) {
+    const __m256i color16 = _mm256_set_epi16(color[3], color[2], color[1], color[0],
+                                             color[3], color[2], color[1], color[0],
+                                             color[3], color[2], color[1], color[0],
+                                             color[3], color[2], color[1], color[0]);
+    const __m128i alpha16 = _mm_set1_epi16(color[3]);
+    const __m256i alphaMask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint64_t cov64;
+        std::memcpy(&cov64, coverage + i, sizeof(cov64));
+        if (cov64 == 0) continue;
+        
+        __m128i cov = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(coverage + i)));
+        __m128i fa = Div255Sse2(_mm_mullo_epi16(cov, alpha16));
+        
+        // Pixels 0-3 and 4-7, each fa repeated over its pixel's four lanes
+        __m128i faLo2 = _mm_unpacklo_epi16(fa, fa);
+        __m128i faHi2 = _mm_unpackhi_epi16(fa, fa);
+        __m256i faLo = _mm256_set_m128i(_mm_unpackhi_epi32(faLo2, faLo2), _mm_unpacklo_epi32(faLo2, faLo2));
+        __m256i faHi = _mm256_set_m128i(_mm_unpackhi_epi32(faHi2, faHi2), _mm_unpacklo_epi32(faHi2, faHi2));
+        
+        uint8_t* d = dst + i * 4;
+        __m128i px0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+        __m128i px1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 16));
+        __m256i lo = BlendAvx2(_mm256_cvtepu8_epi16(px0), faLo, color16, alphaMask);
+        __m256i hi = BlendAvx2(_mm256_cvtepu8_epi16(px1), faHi, color16, alphaMask);
+        
+        // packus works per 128-bit lane: restore pixel order afterwards
+        __m256i packed = _mm256_packus_epi16(lo, hi);
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), packed);
+    }
+    
+    CompositeSpanScalar(dst + i * 4, coverage + i, pixels - i, color);
+}
+
+// Four premultiplied pixels widened to 16 bits, coverage repeated over each
+// pixel's lanes
+IMBORED_TARGET_AVX2
+static inline __m256i SrcOverAvx2(__m256i dst, __m256i src, __m256i cov) {
+    __m256i s = Div255Avx2(_mm256_mullo_epi16(src, cov));
+    __m256i sa = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m256i d = Div255Avx2(_mm256_mullo_epi16(dst, _mm256_sub_epi16(_mm256_set1_epi16(255), sa)));
+    return _mm256_add_epi16(s, d);
+}
+
+IMBORED_TARGET_AVX2
+static void SrcOverSpanAvx2(uint8_t* dst, const uint8_t* src, const uint8_t* coverage, size_t pixels) {
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint64_t cov64;
+        std::memcpy(&cov64, coverage + i, sizeof(cov64));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        // Transparent source or no coverage leaves dst as it was
+        if (cov64 == 0 || _mm256_testz_si256(s, s)) continue;
+        
+        __m128i cov = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(coverage + i)));
+        __m128i covLo2 = _mm_unpacklo_epi16(cov, cov);
+        __m128i covHi2 = _mm_unpackhi_epi16(cov, cov);
+        __m256i covLo = _mm256_set_m128i(_mm_unpackhi_epi32(covLo2, covLo2), _mm_unpacklo_epi32(covLo2, covLo2));
+        __m256i covHi = _mm256_set_m128i(_mm_unpackhi_epi32(covHi2, covHi2), _mm_unpacklo_epi32(covHi2, covHi2));
+        
+        uint8_t* d = dst + i * 4;
+        __m128i px0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+        __m128i px1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 16));
+        __m256i lo = SrcOverAvx2(_mm256_cvtepu8_epi16(px0), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(s)), covLo);
+        __m256i hi = SrcOverAvx2(_mm256_cvtepu8_epi16(px1), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(s, 1)), covHi);
+        
+        __m256i packed = _mm256_packus_epi16(lo, hi);
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), packed);
+    }
+    
+    SrcOverSpanScalar(dst + i * 4, src + i * 4, coverage + i, pixels - i);
+}
+
+IMBORED_TARGET_AVX2
+static void FilterRowsAvx2(uint8_t* dst, const uint8_t* const* rows, const uint16_t* weights, size_t rowCount,
+                           size_t bytes) {
+    const __m256i half = _mm256_set1_epi16(128);
+    
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i lo = half;
+        __m256i hi = half;
+        for (size_t k = 0; k < rowCount; ++k) {
+            __m256i w = _mm256_set1_epi16(static_cast<short>(weights[k]));
+            const uint8_t* row = rows[k] + i;
+            __m256i px0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)));
+            __m256i px1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 16)));
+            lo = _mm256_add_epi16(lo, _mm256_mullo_epi16(px0, w));
+            hi = _mm256_add_epi16(hi, _mm256_mullo_epi16(px1, w));
+        }
+        __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8));
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    
+    FilterRowsTail(dst, rows, weights, rowCount, i, bytes);
+}
+
+static bool CpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    
+    // AVX2 also needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // IMBORED_COMPOSITE_X86
+
+#ifdef IMBORED_COMPOSITE_NEON
+
+// (x + 128 + ((x + 128) >> 8)) >> 8 with NEON's rounding shifts
+static inline uint8x8_t Div255Neon(uint16x8_t x) {
+    return vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+}
+
+static void CompositeSpanNeon(uint8_t* dst, const uint8_t* coverage, size_t pixels, const uint8_t color[4]) {
+    const uint8x8_t r = vdup_n_u8(color[0]);
+    const uint8x8_t g = vdup_n_u8(color[1]);
+    const uint8x8_t b = vdup_n_u8(color[2]);
+    const uint8x8_t a = vdup_n_u8(color[3]);
+    
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint8x8_t cov = vld1_u8(coverage + i);
+        if (vget_lane_u64(vreinterpret_u64_u8(cov), 0) == 0) continue;
+        
+        uint8x8_t fa = Div255Neon(vmull_u8(cov, a));
+        uint8x8_t inv = vmvn_u8(fa);
+        
+        // vld4 splits the pixels into R, G, B and A planes
+        uint8_t* d = dst + i * 4;
+        uint8x8x4_t px = vld4_u8(d);
+        px.val[0] = Div255Neon(vmlal_u8(vmull_u8(r, fa), px.val[0], inv));
+        px.val[1] = Div255Neon(vmlal_u8(vmull_u8(g, fa), px.val[1], inv));
+        px.val[2] = Div255Neon(vmlal_u8(vmull_u8(b, fa), px.val[2], inv));
+        px.val[3] = vmax_u8(fa, px.val[3]);
+        vst4_u8(d, px);
+    }
+    
+    CompositeSpanScalar(dst + i * 4, coverage + i, pixels - i, color);
+}
+
+static void SrcOverSpanNeon(uint8_t* dst, const uint8_t* src, const uint8_t* coverage, size_t pixels) {
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint8x8_t cov = vld1_u8(coverage + i);
+        if (vget_lane_u64(vreinterpret_u64_u8(cov), 0) == 0) continue;
+        
+        uint8x8x4_t s = vld4_u8(src + i * 4);
+        uint8x8_t sa = Div255Neon(vmull_u8(s.val[3], cov));
+        uint8x8_t inv = vmvn_u8(sa);
+        
+        uint8_t* d = dst + i * 4;
+        uint8x8x4_t px = vld4_u8(d);
+        for (int c = 0; c < 3; ++c) {
+            px.val[c] = vqadd_u8(Div255Neon(vmull_u8(s.val[c], cov)), Div255Neon(vmull_u8(px.val[c], inv)));
+        }
+        px.val[3] = vqadd_u8(sa, Div255Neon(vmull_u8(px.val[3], inv)));
+        vst4_u8(d, px);
+    }
+    
+    SrcOverSpanScalar(dst + i * 4, src + i * 4, coverage + i, pixels - i);
+}
+
+static void FilterRowsNeon(uint8_t* dst, const uint8_t* const* rows, const uint16_t* weights, size_t rowCount,
+                           size_t bytes) {
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        uint16x8_t lo = vdupq_n_u16(0);
+        uint16x8_t hi = vdupq_n_u16(0);
+        for (size_t k = 0; k < rowCount; ++k) {
+            uint8x16_t px = vld1q_u8(rows[k] + i);
+            lo = vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(px)), weights[k]);
+            hi = vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(px)), weights[k]);
+        }
+        // Rounding narrow adds the 128
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+    
+    FilterRowsTail(dst, rows, weights, rowCount, i, bytes);
+}
+
+#endif // IMBORED_COMPOSITE_NEON
+
+std::vector<CompositeKernelSet> GetAvailableCompositeKernels() {
+    std::vector<CompositeKernelSet> kernels;
+#if defined(IMBORED_COMPOSITE_X86)
+    if (CpuHasAvx2()) {
+        kernels.push_back({CompositeSpanAvx2, SrcOverSpanAvx2, FilterRowsAvx2, "AVX2"});
+    }
+    kernels.push_back({CompositeSpanSse2, SrcOverSpanSse2, FilterRowsSse2, "SSE2"});
+#elif defined(IMBORED_COMPOSITE_NEON)
+    kernels.push_back({CompositeSpanNeon, SrcOverSpanNeon, FilterRowsNeon, "NEON"});
+#endif
+    kernels.push_back({CompositeSpanScalar, SrcOverSpanScalar, FilterRowsScalar, "scalar"});
+    return kernels;
+}
+
+static const CompositeKernelSet& GetSelectedKernel() {
+    static const CompositeKernelSet kernel = GetAvailableCompositeKernels().front();
+    return kernel;
+}
+
+CompositeSpanFn GetCompositeSpanKernel() {
+    return GetSelectedKernel().composite;
+}
+
+SrcOverSpanFn GetSrcOverSpanKernel() {
+    return GetSelectedKernel().srcOver;
+}
+
+FilterRowsFn GetFilterRowsKernel() {
+    return GetSelectedKernel().filterRows;
+}
+
+const char* GetCompositeSpanKernelName() {
+    return GetSelectedKernel().name;
+}
+
+} // namespace ImBored::UI
@@ -0,0 +1,419 @@
+#include "ui/emoji_atlas_cache.hpp"
+#include "core/mapped_file.hpp"
+#include <iostream>
+#include <filesystem>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <random>
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ImBored::UI {
+
+namespace {
+
+constexpr char CACHE_MAGIC[4] = {'I', 'B', 'E', 'A'};
+
+// Bump whenever the file layout below changes
+constexpr uint32_t CACHE_FORMAT_VERSION = 4;
+
+// File layout: header, page headers, every page's skyline, glyph table,
+// every page's pixels, then a 64-bit hash chained over all of those in
+// order so it can be computed while they are written
+struct CacheFileHeader {
+    char magic[4];
+    uint32_t formatVersion;
+    uint64_t fontHash;
+    uint32_t pixelSize;
+    uint32_t rendererVersion;
+    uint32_t pageCount;
+    uint32_t glyphCount;
+};
+
+struct CachePageHeader {
+    int32_t width;
+    int32_t height;
+    int64_t usedArea;
+    uint32_t skylineCount;
+    uint32_t reserved;
+};
+
+// Fold one section of the file into the running hash
+uint64_t hashSection(uint64_t hash, const void* data, size_t size) {
+    uint64_t section = EmojiAtlasCache::hashBytes(static_cast<const uint8_t*>(data), size);
+    return (hash ^ section) * 0x9E3779B97F4A7C15ull;
+}
+
+// A restored skyline must stay inside its page or the packer would hand
+// out rects past the pixel buffer
+bool skylineFits(const std::vector<SkylineNode>& skyline, const CachePageHeader& page) {
+    for (const SkylineNode& node : skyline) {
+        if (node.x < 0 || node.width <= 0 || node.y < 0 ||
+            static_cast<int64_t>(node.x) + node.width > page.width || node.y > page.height) {
+            return false;
+        }
+    }
+    return page.usedArea <= static_cast<int64_t>(page.width) * page.height;
+}
+
+// Glyph rects are copied out of the page and the ink box out of a
+// pixelSize square, so both have to lie inside them
+bool entryFits(const EmojiAtlasCacheEntry& entry, const std::vector<CachePageHeader>& pages, uint32_t pixelSize) {
+    if (entry.page >= pages.size()) {
+        return false;
+    }
+    const CachePageHeader& page = pages[entry.page];
+    int64_t size = static_cast<int64_t>(pixelSize);
+    return entry.atlasX >= 0 && entry.atlasY >= 0 && entry.inkWidth >= 0 && entry.inkHeight >= 0 &&
+           static_cast<int64_t>(entry.atlasX) + entry.inkWidth <= page.width &&
+           static_cast<int64_t>(entry.atlasY) + entry.inkHeight <= page.height &&
+           entry.inkX >= 0 && entry.inkY >= 0 &&
+           static_cast<int64_t>(entry.inkX) + entry.inkWidth <= size &&
+           static_cast<int64_t>(entry.inkY) + entry.inkHeight <= size;
+}
+
+// Temp name next to the destination that no other process or thread will pick
+std::string uniqueTempPath(const std::string& path) {
+#ifdef _WIN32
+    unsigned long pid = static_cast<unsigned long>(_getpid());
+#else
+    unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    std::random_device random;
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%lu.%08x.tmp", pid, static_cast<unsigned>(random()));
+    return path + suffix;
+}
+
+// Creates path for writing, failing if it already exists
+int createExclusive(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(path.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0644);
+#endif
+}
+
+// Writes all of data, retrying short writes
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    size_t remaining = size;
+    while (remaining > 0) {
+#ifdef _WIN32
+        int written = _write(fd, bytes, static_cast<unsigned>(std::min<size_t>(remaining, 1u << 30)));
+#else
+        ssize_t written = write(fd, bytes, remaining);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Syncs the data to disk so a crash after the following rename can't leave
+// a truncated file in place, then closes fd
+bool closeSynced(int fd) {
+#ifdef _WIN32
+    bool ok = _commit(fd) == 0;
+    return _close(fd) == 0 && ok;
+#else
+    bool ok = fsync(fd) == 0;
+    return close(fd) == 0 && ok;
+#endif
+}
+
+} // namespace
+
+EmojiAtlasCache::EmojiAtlasCache()
+    : m_directory(defaultDirectory())
+{
+}
+
+uint64_t EmojiAtlasCache::hashBytes(const uint8_t* data, size_t size) {
+    // FNV-1a over 64-bit words with an extra shift to mix high bits down
+    const uint64_t prime = 0x100000001B3ull;
+    uint64_t hash = 0xCBF29CE484222325ull ^ size;
+    
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * prime;
+    }
+    
+    return hash;
+}
+
+uint64_t EmojiAtlasCache::hashFont(const uint8_t* data, size_t size) {
+    // sfnt header: version, numTables, 3 search fields, then 16-byte table
+    // records (tag, checksum, offset, length)
+    if (size >= 12) {
+        uint32_t version = (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+        uint16_t numTables = static_cast<uint16_t>((data[4] << 8) | data[5]);
+        size_t directorySize = 12 + static_cast<size_t>(numTables) * 16;
+        
+        bool sfnt = version == 0x00010000 || version == 0x4F54544F || version == 0x74727565; // 1.0, 'OTTO', 'true'
+        if (sfnt && numTables > 0 && directorySize <= size) {
+            // The file size catches edits that forgot to update checksums
+            return hashBytes(data, directorySize) ^ (static_cast<uint64_t>(size) * 0x9E3779B97F4A7C15ull);
+        }
+    }
+    
+    return hashBytes(data, size);
+}
+
+std::string EmojiAtlasCache::defaultDirectory() {
+    namespace fs = std::filesystem;
+    
+#ifdef _WIN32
+    if (const char* localAppData = std::getenv("LOCALAPPDATA")) {
+        return (fs::path(localAppData) / "ImBored" / "cache").string();
+    }
+#elif defined(__APPLE__)
+    if (const char* home = std::getenv("HOME")) {
+        return (fs::path(home) / "Library" / "Caches" / "ImBored").string();
+    }
+#else
+    if (const char* xdgCache = std::getenv("XDG_CACHE_HOME"); xdgCache && *xdgCache) {
+        return (fs::path(xdgCache) / "imbored").string();
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return (fs::path(home) / ".cache" / "imbored").string();
+    }
+#endif
+    
+    std::error_code ec;
+    return (fs::temp_directory_path(ec) / "imbored").string();
+}
+
+std::string EmojiAtlasCache::pathFor(const EmojiAtlasCacheKey& key) const {
+    // Renderer version lives in the header so stale files get overwritten
+    // instead of piling up next to the current ones
+    char name[64];
+    std::snprintf(name, sizeof(name), "emoji_%016llx_%upx.atlas",
+                  static_cast<unsigned long long>(key.fontHash), key.pixelSize);
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+bool EmojiAtlasCache::load(const EmojiAtlasCacheKey& key, std::vector<std::unique_ptr<EmojiAtlasPage>>& pages,
+                           std::vector<EmojiAtlasCacheEntry>& glyphs) const {
+    std::string path = pathFor(key);
+    
+    Core::MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    
+    if (file.size() < sizeof(CacheFileHeader)) {
+        std::cerr << "EmojiAtlasCache: Truncated cache file " << path << "\n";
+        return false;
+    }
+    
+    CacheFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.formatVersion != CACHE_FORMAT_VERSION) {
+        std::cerr << "EmojiAtlasCache: Unrecognized cache file " << path << "\n";
+        return false;
+    }
+    
+    if (header.fontHash != key.fontHash || header.pixelSize != key.pixelSize ||
+        header.rendererVersion != key.rendererVersion) {
+        std::cout << "EmojiAtlasCache: Stale cache file " << path << "\n";
+        return false;
+    }
+    
+    size_t pageHeaderBytes = static_cast<size_t>(header.pageCount) * sizeof(CachePageHeader);
+    if (header.pageCount == 0 || file.size() < sizeof(header) + pageHeaderBytes) {
+        std::cerr << "EmojiAtlasCache: Corrupt cache header in " << path << "\n";
+        return false;
+    }
+    
+    std::vector<CachePageHeader> pageHeaders(header.pageCount);
+    std::memcpy(pageHeaders.data(), file.data() + sizeof(header), pageHeaderBytes);
+    
+    // Validate every size before touching the payload
+    size_t skylineBytes = 0;
+    size_t pixelBytes = 0;
+    for (const CachePageHeader& page : pageHeaders) {
+        if (page.width <= 0 || page.height <= 0 || page.usedArea < 0 || page.skylineCount == 0) {
+            std::cerr << "EmojiAtlasCache: Corrupt page header in " << path << "\n";
+            return false;
+        }
+        skylineBytes += static_cast<size_t>(page.skylineCount) * sizeof(SkylineNode);
+        pixelBytes += static_cast<size_t>(page.width) * page.height * 4;
+    }
+    
+    size_t glyphBytes = static_cast<size_t>(header.glyphCount) * sizeof(EmojiAtlasCacheEntry);
+    size_t hashedBytes = sizeof(header) + pageHeaderBytes + skylineBytes + glyphBytes + pixelBytes;
+    if (file.size() != hashedBytes + sizeof(uint64_t)) {
+        std::cerr << "EmojiAtlasCache: Size mismatch in " << path << "\n";
+        return false;
+    }
+    
+    const uint8_t* skylineData = file.data() + sizeof(header) + pageHeaderBytes;
+    const uint8_t* glyphData = skylineData + skylineBytes;
+    const uint8_t* pixelData = glyphData + glyphBytes;
+    
+    // Same section order store() hashed them in
+    uint64_t hash = hashSection(0, &header, sizeof(header));
+    hash = hashSection(hash, pageHeaders.data(), pageHeaderBytes);
+    const uint8_t* section = skylineData;
+    for (const CachePageHeader& page : pageHeaders) {
+        size_t bytes = static_cast<size_t>(page.skylineCount) * sizeof(SkylineNode);
+        hash = hashSection(hash, section, bytes);
+        section += bytes;
+    }
+    hash = hashSection(hash, glyphData, glyphBytes);
+    section = pixelData;
+    for (const CachePageHeader& page : pageHeaders) {
+        size_t bytes = static_cast<size_t>(page.width) * page.height * 4;
+        hash = hashSection(hash, section, bytes);
+        section += bytes;
+    }
+    
+    uint64_t storedHash;
+    std::memcpy(&storedHash, file.data() + hashedBytes, sizeof(storedHash));
+    if (hash != storedHash) {
+        std::cerr << "EmojiAtlasCache: Checksum mismatch in " << path << "\n";
+        return false;
+    }
+    
+    std::vector<std::vector<SkylineNode>> skylines(pageHeaders.size());
+    for (size_t i = 0; i < pageHeaders.size(); ++i) {
+        skylines[i].resize(pageHeaders[i].skylineCount);
+        std::memcpy(skylines[i].data(), skylineData, skylines[i].size() * sizeof(SkylineNode));
+        skylineData += skylines[i].size() * sizeof(SkylineNode);
+        if (!skylineFits(skylines[i], pageHeaders[i])) {
+            std::cerr << "EmojiAtlasCache: Skyline outside its page in " << path << "\n";
+            return false;
+        }
+    }
+    
+    std::vector<EmojiAtlasCacheEntry> entries(header.glyphCount);
+    std::memcpy(entries.data(), glyphData, glyphBytes);
+    for (const EmojiAtlasCacheEntry& entry : entries) {
+        if (!entryFits(entry, pageHeaders, header.pixelSize)) {
+            std::cerr << "EmojiAtlasCache: Glyph rect outside its page in " << path << "\n";
+            return false;
+        }
+    }
+    
+    pages.clear();
+    for (size_t i = 0; i < pageHeaders.size(); ++i) {
+        auto page = std::make_unique<EmojiAtlasPage>(pageHeaders[i].width, pageHeaders[i].height);
+        page->restore(skylines[i], pageHeaders[i].usedArea, pixelData);
+        pixelData += page->getBytes();
+        pages.push_back(std::move(page));
+    }
+    glyphs = std::move(entries);
+    
+    return true;
+}
+
+bool EmojiAtlasCache::store(const EmojiAtlasCacheKey& key, const std::vector<std::unique_ptr<EmojiAtlasPage>>& pages,
+                            const std::vector<EmojiAtlasCacheEntry>& glyphs) const {
+    namespace fs = std::filesystem;
+    
+    if (pages.empty()) {
+        return false;
+    }
+    
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+    if (ec) {
+        std::cerr << "EmojiAtlasCache: Cannot create " << m_directory << ": " << ec.message() << "\n";
+        return false;
+    }
+    
+    std::vector<CachePageHeader> pageHeaders;
+    pageHeaders.reserve(pages.size());
+    for (const auto& page : pages) {
+        CachePageHeader pageHeader = {};
+        pageHeader.width = page->getWidth();
+        pageHeader.height = page->getHeight();
+        pageHeader.usedArea = page->getPacker().getUsedArea();
+        pageHeader.skylineCount = static_cast<uint32_t>(page->getPacker().getNodes().size());
+        pageHeaders.push_back(pageHeader);
+    }
+    
+    CacheFileHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.formatVersion = CACHE_FORMAT_VERSION;
+    header.fontHash = key.fontHash;
+    header.pixelSize = key.pixelSize;
+    header.rendererVersion = key.rendererVersion;
+    header.pageCount = static_cast<uint32_t>(pages.size());
+    header.glyphCount = static_cast<uint32_t>(glyphs.size());
+    
+    // Sections in file order, each hashed as it is written
+    std::vector<std::pair<const void*, size_t>> sections;
+    sections.push_back({&header, sizeof(header)});
+    sections.push_back({pageHeaders.data(), pageHeaders.size() * sizeof(CachePageHeader)});
+    for (const auto& page : pages) {
+        const std::vector<SkylineNode>& nodes = page->getPacker().getNodes();
+        sections.push_back({nodes.data(), nodes.size() * sizeof(SkylineNode)});
+    }
+    sections.push_back({glyphs.data(), glyphs.size() * sizeof(EmojiAtlasCacheEntry)});
+    for (const auto& page : pages) {
+        sections.push_back({page->getPixels().data(), page->getBytes()});
+    }
+    
+    std::string path = pathFor(key);
+    std::string tempPath = uniqueTempPath(path);
+    
+    int fd = createExclusive(tempPath);
+    bool written = fd >= 0;
+    uint64_t hash = 0;
+    for (const auto& section : sections) {
+        if (!written) {
+            break;
+        }
+        hash = hashSection(hash, section.first, section.second);
+        written = writeAll(fd, section.first, section.second);
+    }
+    written = written && writeAll(fd, &hash, sizeof(hash));
+    if (fd >= 0) {
+        written = closeSynced(fd) && written;
+    }
+    
+    if (!written) {
+        std::cerr << "EmojiAtlasCache: Failed writing " << tempPath << "\n";
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    
+    // Data is on disk before rename(), which replaces the destination atomically
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "EmojiAtlasCache: Cannot replace " << path << ": " << ec.message() << "\n";
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    
+    std::cout << "EmojiAtlasCache: Saved " << glyphs.size() << " glyphs in " << pages.size()
+              << " pages to " << path << "\n";
+    return true;
+}
+
+} // namespace ImBored::UI
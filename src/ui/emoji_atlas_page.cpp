@@ -0,0 +1,224 @@
+#include "ui/emoji_atlas_page.hpp"
+#include <algorithm>
+#include <cstring>
+
+// OpenGL for texture creation
+#include <glad/gl.h>
+
+namespace ImBored::UI {
+
+EmojiAtlasPage::EmojiAtlasPage(int width, int height)
+    : m_width(width)
+    , m_height(height)
+    , m_liveRects(0)
+    , m_liveArea(0)
+    , m_textureID(nullptr)
+    , m_textureWidth(0)
+    , m_textureHeight(0)
+{
+    m_pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+    m_packer.reset(width, height);
+}
+
+EmojiAtlasPage::~EmojiAtlasPage() {
+    if (m_textureID) {
+        GLuint texID = (GLuint)(uintptr_t)m_textureID;
+        glDeleteTextures(1, &texID);
+    }
+}
+
+bool EmojiAtlasPage::allocate(int width, int height, int& x, int& y) {
+    // Best-fit among evicted slots first
+    int best = -1;
+    int64_t bestArea = 0;
+    for (size_t i = 0; i < m_freeRects.size(); ++i) {
+        const AtlasRect& rect = m_freeRects[i];
+        int64_t area = static_cast<int64_t>(rect.width) * rect.height;
+        if (rect.width >= width && rect.height >= height && (best < 0 || area < bestArea)) {
+            best = static_cast<int>(i);
+            bestArea = area;
+        }
+    }
+    
+    if (best >= 0) {
+        AtlasRect slot = m_freeRects[best];
+        m_freeRects.erase(m_freeRects.begin() + best);
+        
+        // Guillotine split: what is left to the right and below stays free
+        if (slot.width > width) {
+            m_freeRects.push_back({slot.x + width, slot.y, slot.width - width, height});
+        }
+        if (slot.height > height) {
+            m_freeRects.push_back({slot.x, slot.y + height, slot.width, slot.height - height});
+        }
+        
+        x = slot.x;
+        y = slot.y;
+        m_liveRects++;
+        m_liveArea += static_cast<int64_t>(width) * height;
+        return true;
+    }
+    
+    if (!m_packer.pack(width, height, x, y)) {
+        return false;
+    }
+    m_liveRects++;
+    m_liveArea += static_cast<int64_t>(width) * height;
+    return true;
+}
+
+void EmojiAtlasPage::release(const AtlasRect& rect) {
+    m_liveRects--;
+    m_liveArea -= static_cast<int64_t>(rect.width) * rect.height;
+    if (m_liveRects <= 0) {
+        // Empty page: drop the fragmented free list and start over
+        m_liveRects = 0;
+        m_liveArea = 0;
+        m_freeRects.clear();
+        m_packer.reset(m_width, m_height);
+        clear(0, 0, m_width, m_height);
+        return;
+    }
+    
+    clear(rect.x, rect.y, rect.width, rect.height);
+    addFreeRect(rect);
+}
+
+void EmojiAtlasPage::addFreeRect(AtlasRect rect) {
+    // Evicting neighbours then gives back one slot a larger glyph can use,
+    // instead of several that each are too small
+    for (size_t i = 0; i < m_freeRects.size();) {
+        const AtlasRect& other = m_freeRects[i];
+        if (other.x == rect.x && other.width == rect.width &&
+            (other.y + other.height == rect.y || rect.y + rect.height == other.y)) {
+            rect.y = std::min(rect.y, other.y);
+            rect.height += other.height;
+        } else if (other.y == rect.y && other.height == rect.height &&
+                   (other.x + other.width == rect.x || rect.x + rect.width == other.x)) {
+            rect.x = std::min(rect.x, other.x);
+            rect.width += other.width;
+        } else {
+            ++i;
+            continue;
+        }
+        
+        // The grown rect may now line up with ones already passed
+        m_freeRects[i] = m_freeRects.back();
+        m_freeRects.pop_back();
+        i = 0;
+    }
+    m_freeRects.push_back(rect);
+}
+
+void EmojiAtlasPage::clear(int x, int y, int width, int height) {
+    for (int row = 0; row < height; ++row) {
+        uint8_t* dst = &m_pixels[(static_cast<size_t>(y + row) * m_width + x) * 4];
+        std::memset(dst, 0, static_cast<size_t>(width) * 4);
+    }
+    m_dirtyRects.push_back({x, y, width, height});
+}
+
+void EmojiAtlasPage::grow() {
+    // Double the shorter side so the page stays close to square
+    int newWidth = m_width;
+    int newHeight = m_height;
+    if (m_width <= m_height) {
+        newWidth *= 2;
+    } else {
+        newHeight *= 2;
+    }
+    
+    if (newWidth == m_width) {
+        // Rows keep their stride, so existing pixels stay where they are
+        m_pixels.resize(static_cast<size_t>(newWidth) * newHeight * 4, 0);
+    } else {
+        std::vector<uint8_t> grown(static_cast<size_t>(newWidth) * newHeight * 4, 0);
+        size_t rowBytes = static_cast<size_t>(m_width) * 4;
+        for (int row = 0; row < m_height; ++row) {
+            std::memcpy(&grown[static_cast<size_t>(row) * newWidth * 4],
+                        &m_pixels[row * rowBytes], rowBytes);
+        }
+        m_pixels.swap(grown);
+    }
+    
+    m_width = newWidth;
+    m_height = newHeight;
+    m_packer.grow(newWidth, newHeight);
+    m_dirtyRects.clear();
+}
+
+void EmojiAtlasPage::write(int x, int y, int width, int height, const uint8_t* src, size_t srcStride) {
+    for (int row = 0; row < height; ++row) {
+        uint8_t* dst = &m_pixels[(static_cast<size_t>(y + row) * m_width + x) * 4];
+        std::memcpy(dst, src + row * srcStride, static_cast<size_t>(width) * 4);
+    }
+    m_dirtyRects.push_back({x, y, width, height});
+}
+
+void EmojiAtlasPage::restore(const std::vector<SkylineNode>& skyline, int64_t usedArea, const uint8_t* pixels) {
+    m_packer.restore(m_width, m_height, skyline, usedArea);
+    std::memcpy(m_pixels.data(), pixels, m_pixels.size());
+    m_dirtyRects.assign(1, {0, 0, m_width, m_height});
+}
+
+void EmojiAtlasPage::upload() {
+    if (!m_textureID) {
+        GLuint texID;
+        glGenTextures(1, &texID);
+        glBindTexture(GL_TEXTURE_2D, texID);
+        
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        
+        m_textureID = (void*)(uintptr_t)texID;
+    }
+    
+    GLuint texID = (GLuint)(uintptr_t)m_textureID;
+    
+    // Storage is only (re)allocated when the page changes size
+    if (m_textureWidth != m_width || m_textureHeight != m_height) {
+        glBindTexture(GL_TEXTURE_2D, texID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height,
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, m_pixels.data());
+        m_textureWidth = m_width;
+        m_textureHeight = m_height;
+        m_dirtyRects.clear();
+        return;
+    }
+    
+    if (m_dirtyRects.empty()) {
+        return;
+    }
+    
+    // One upload of the bounding box is cheaper than many small ones as
+    // long as it does not drag in much clean space
+    AtlasRect bounds = m_dirtyRects[0];
+    int64_t dirtyArea = 0;
+    for (const AtlasRect& rect : m_dirtyRects) {
+        int right = std::max(bounds.x + bounds.width, rect.x + rect.width);
+        int bottom = std::max(bounds.y + bounds.height, rect.y + rect.height);
+        bounds.x = std::min(bounds.x, rect.x);
+        bounds.y = std::min(bounds.y, rect.y);
+        bounds.width = right - bounds.x;
+        bounds.height = bottom - bounds.y;
+        dirtyArea += static_cast<int64_t>(rect.width) * rect.height;
+    }
+    if (static_cast<int64_t>(bounds.width) * bounds.height <= dirtyArea * 2) {
+        m_dirtyRects.assign(1, bounds);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, texID);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_width);
+    for (const AtlasRect& rect : m_dirtyRects) {
+        const uint8_t* origin = &m_pixels[(static_cast<size_t>(rect.y) * m_width + rect.x) * 4];
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, origin);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    
+    m_dirtyRects.clear();
+}
+
+} // namespace ImBored::UI
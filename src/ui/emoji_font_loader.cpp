@@ -0,0 +1,136 @@
+#include "ui/emoji_font_loader.hpp"
+#include "ui/emoji_manager.hpp"
+#include "imgui_internal.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace ImBored::UI {
+
+// Manager for emoji sources. ImGui requires FontLoaderData to be empty
+// when a source is added, and sources are re-initialized when the atlas
+// reloads, so FontSrcInit picks it up from here.
+static EmojiManager* g_emojiManager = nullptr;
+
+// Reused between glyphs, the loader only runs on the UI thread
+static std::vector<uint8_t> g_glyphPixels;
+
+static bool EmojiLoader_FontSrcInit(ImFontAtlas* atlas, ImFontConfig* src) {
+    IM_UNUSED(atlas);
+    if (!g_emojiManager) {
+        return false;
+    }
+    
+    src->FontLoaderData = g_emojiManager;
+    return true;
+}
+
+static void EmojiLoader_FontSrcDestroy(ImFontAtlas* atlas, ImFontConfig* src) {
+    IM_UNUSED(atlas);
+    src->FontLoaderData = nullptr;
+}
+
+static bool EmojiLoader_FontSrcContainsGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImWchar codepoint) {
+    IM_UNUSED(atlas);
+    EmojiManager* emojiManager = (EmojiManager*)src->FontLoaderData;
+    return emojiManager->isEmoji(codepoint);
+}
+
+static bool EmojiLoader_FontBakedLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked,
+                                           void* loaderData, ImWchar codepoint,
+                                           ImFontGlyph* outGlyph, float* outAdvanceX) {
+    IM_UNUSED(loaderData);
+    EmojiManager* emojiManager = (EmojiManager*)src->FontLoaderData;
+    if (!emojiManager->isEmoji(codepoint)) {
+        return false;
+    }
+    
+    // Emoji are square and as wide as the font size
+    float size = baked->Size;
+    if (src->MergeMode && src->SizePixels != 0.0f) {
+        size *= src->SizePixels / baked->ContainerFont->Sources[0]->SizePixels;
+    }
+    const float density = src->RasterizerDensity * baked->RasterizerDensity;
+    
+    // Load metrics only mode
+    if (outAdvanceX != nullptr) {
+        IM_ASSERT(outGlyph == nullptr);
+        *outAdvanceX = size;
+        return true;
+    }
+    
+    int pixelSize = std::max(1, static_cast<int>(std::ceil(size * density)));
+    if (!emojiManager->rasterizeGlyph(codepoint, pixelSize, g_glyphPixels)) {
+        return false;
+    }
+    
+    outGlyph->Codepoint = codepoint;
+    outGlyph->AdvanceX = size;
+    
+    // Only the ink is packed, offsets keep it in place inside the box
+    int left = pixelSize, top = pixelSize, right = 0, bottom = 0;
+    for (int row = 0; row < pixelSize; ++row) {
+        const uint8_t* line = &g_glyphPixels[static_cast<size_t>(row) * pixelSize * 4];
+        for (int col = 0; col < pixelSize; ++col) {
+            if (line[col * 4 + 3] != 0) {
+                left = std::min(left, col);
+                right = std::max(right, col + 1);
+                top = std::min(top, row);
+                bottom = std::max(bottom, row + 1);
+            }
+        }
+    }
+    if (right <= left || bottom <= top) {
+        return true;
+    }
+    
+    int width = right - left;
+    int height = bottom - top;
+    ImFontAtlasRectId packId = ImFontAtlasPackAddRect(atlas, width, height);
+    if (packId == ImFontAtlasRectId_Invalid) {
+        IM_ASSERT(packId != ImFontAtlasRectId_Invalid && "Out of texture memory.");
+        return false;
+    }
+    ImTextureRect* rect = ImFontAtlasPackGetRect(atlas, packId);
+    
+    // Center the box on the line of the font it is merged into
+    const float boxTop = (baked->Ascent - baked->Descent - size) * 0.5f + src->GlyphOffset.y;
+    const float boxLeft = src->GlyphOffset.x;
+    const float scale = 1.0f / density;
+    outGlyph->X0 = boxLeft + left * scale;
+    outGlyph->Y0 = boxTop + top * scale;
+    outGlyph->X1 = boxLeft + right * scale;
+    outGlyph->Y1 = boxTop + bottom * scale;
+    outGlyph->Visible = true;
+    outGlyph->Colored = true;
+    outGlyph->PackId = packId;
+    
+    const uint8_t* ink = &g_glyphPixels[(static_cast<size_t>(top) * pixelSize + left) * 4];
+    ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, src, outGlyph, rect, ink, ImTextureFormat_RGBA32, pixelSize * 4);
+    return true;
+}
+
+const ImFontLoader* GetEmojiFontLoader() {
+    static ImFontLoader loader;
+    loader.Name = "ImBored Emoji";
+    loader.FontSrcInit = EmojiLoader_FontSrcInit;
+    loader.FontSrcDestroy = EmojiLoader_FontSrcDestroy;
+    loader.FontSrcContainsGlyph = EmojiLoader_FontSrcContainsGlyph;
+    loader.FontBakedLoadGlyph = EmojiLoader_FontBakedLoadGlyph;
+    loader.FontBakedSrcLoaderDataSize = 0;
+    return &loader;
+}
+
+ImFont* MergeEmojiFont(ImFontAtlas* atlas, EmojiManager* emojiManager, ImFont* dstFont) {
+    ImFontConfig config;
+    config.MergeMode = true;
+    config.DstFont = dstFont;
+    config.FontLoader = GetEmojiFontLoader();
+    std::snprintf(config.Name, sizeof(config.Name), "Color Emoji");
+    
+    g_emojiManager = emojiManager;
+    return atlas->AddFont(&config);
+}
+
+} // namespace ImBored::UI
@@ -1,8 +1,19 @@
 #include "ui/emoji_manager.hpp"
 #include "ui/colrv1_renderer.hpp"
+#include "ui/glyph_raster_pool.hpp"
+#include "ui/font_blob_registry.hpp"
+#include "ui/glyph_cache.hpp"
+#include "ui/svg_glyph_table.hpp"
+#include "ui/composite_kernels.hpp"
+#include "ui/bitmap_resampler.hpp"
+#include "core/mapped_file.hpp"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 
 // FreeType headers
 #include <ft2build.h>
@@ -21,35 +32,151 @@
 
 namespace ImBored::UI {
 
-// Emoji ranges we want to support
-static const std::vector<std::pair<uint32_t, uint32_t>> EMOJI_RANGES = {
-    {0x1F300, 0x1F5FF}, // Miscellaneous Symbols and Pictographs
-    {0x1F600, 0x1F64F}, // Emoticons
-    {0x1F680, 0x1F6FF}, // Transport and Map Symbols
-    {0x1F900, 0x1F9FF}, // Supplemental Symbols and Pictographs
-    {0x2600,  0x26FF},  // Miscellaneous Symbols
-    {0x2700,  0x27BF},  // Dingbats
+// Codepoints with the Unicode Extended_Pictographic property (emoji-data
+// 15.0), plus regional indicators and skin tone modifiers. Sorted and
+// inclusive. Pictographs below U+2000 (©, ®) are left out: they default
+// to text presentation and are common in plain text.
+static const std::pair<uint32_t, uint32_t> EMOJI_PROPERTY_RANGES[] = {
+    {0x203C,  0x203C},  {0x2049,  0x2049},  {0x2122,  0x2122},  {0x2139,  0x2139},
+    {0x2194,  0x2199},  {0x21A9,  0x21AA},  {0x231A,  0x231B},  {0x2328,  0x2328},
+    {0x2388,  0x2388},  {0x23CF,  0x23CF},  {0x23E9,  0x23F3},  {0x23F8,  0x23FA},
+    {0x24C2,  0x24C2},  {0x25AA,  0x25AB},  {0x25B6,  0x25B6},  {0x25C0,  0x25C0},
+    {0x25FB,  0x25FE},  {0x2600,  0x2605},  {0x2607,  0x2612},  {0x2614,  0x2685},
+    {0x2690,  0x2705},  {0x2708,  0x2712},  {0x2714,  0x2714},  {0x2716,  0x2716},
+    {0x271D,  0x271D},  {0x2721,  0x2721},  {0x2728,  0x2728},  {0x2733,  0x2734},
+    {0x2744,  0x2744},  {0x2747,  0x2747},  {0x274C,  0x274C},  {0x274E,  0x274E},
+    {0x2753,  0x2755},  {0x2757,  0x2757},  {0x2763,  0x2767},  {0x2795,  0x2797},
+    {0x27A1,  0x27A1},  {0x27B0,  0x27B0},  {0x27BF,  0x27BF},  {0x2934,  0x2935},
+    {0x2B05,  0x2B07},  {0x2B1B,  0x2B1C},  {0x2B50,  0x2B50},  {0x2B55,  0x2B55},
+    {0x3030,  0x3030},  {0x303D,  0x303D},  {0x3297,  0x3297},  {0x3299,  0x3299},
+    {0x1F000, 0x1F0FF}, {0x1F10D, 0x1F10F}, {0x1F12F, 0x1F12F}, {0x1F16C, 0x1F171},
+    {0x1F17E, 0x1F17F}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F1AD, 0x1F1FF},
+    {0x1F201, 0x1F20F}, {0x1F21A, 0x1F21A}, {0x1F22F, 0x1F22F}, {0x1F232, 0x1F23A},
+    {0x1F23C, 0x1F23F}, {0x1F249, 0x1F53D}, {0x1F546, 0x1F64F}, {0x1F680, 0x1F6FF},
+    {0x1F774, 0x1F77F}, {0x1F7D5, 0x1F7FF}, {0x1F80C, 0x1F80F}, {0x1F848, 0x1F84F},
+    {0x1F85A, 0x1F85F}, {0x1F888, 0x1F88F}, {0x1F8AE, 0x1F8FF}, {0x1F90C, 0x1F93A},
+    {0x1F93C, 0x1F945}, {0x1F947, 0x1FAFF}, {0x1FC00, 0x1FFFD},
 };
 
+// Smallest page edge; a page doubles along its shorter side when full
+static constexpr int MIN_ATLAS_SIZE = 256;
+
+// Largest page edge, also capped by GL_MAX_TEXTURE_SIZE. Past this the
+// atlas spills into another page instead of one giant allocation.
+static constexpr int MAX_PAGE_SIZE = 2048;
+
+// Transparent gutter between packed glyphs so linear filtering never bleeds
+static constexpr int ATLAS_PADDING = 1;
+
+// Default FreeType glyph cache budget, split between the main thread and
+// the raster workers
+static constexpr size_t DEFAULT_GLYPH_CACHE_BYTES = 4 * 1024 * 1024;
+
+// Atlas rasterization size for a font size, larger for better quality
+static int pixelSizeFor(float fontSize) {
+    return std::max(32, static_cast<int>(fontSize * 2));
+}
+
+// Nearest-neighbour enlargement of an RGBA square, for the rare request
+// above the atlas size; shrinking goes through BitmapResampler
+static void upscaleGlyph(const uint8_t* src, int srcSize, std::vector<uint8_t>& dst, int dstSize) {
+    dst.resize(static_cast<size_t>(dstSize) * dstSize * 4);
+    for (int y = 0; y < dstSize; ++y) {
+        const uint8_t* row = src + static_cast<size_t>(y * srcSize / dstSize) * srcSize * 4;
+        uint8_t* out = &dst[static_cast<size_t>(y) * dstSize * 4];
+        for (int x = 0; x < dstSize; ++x, out += 4) {
+            std::memcpy(out, row + static_cast<size_t>(x * srcSize / dstSize) * 4, 4);
+        }
+    }
+}
+
+// setFontSize() work done off the UI thread: load the persisted atlas for
+// the new size and rasterize what was on screen. The UI thread only reads
+// the job after done is set.
+struct EmojiManager::RebuildJob {
+    float fontSize;
+    int pixelSize;
+    std::vector<GlyphRasterJob> jobs;
+    GlyphRasterBatch results;
+    std::vector<std::unique_ptr<EmojiAtlasPage>> cachedPages;
+    std::vector<EmojiAtlasCacheEntry> cachedEntries;
+    bool cacheLoaded;
+    std::atomic<bool> done;
+    std::thread thread;
+};
+
+// The atlas being swapped out by finishRebuild(), written to disk off the
+// UI thread. The pages come back to the UI thread to be destroyed since
+// they own GL textures.
+struct EmojiManager::CacheWriteJob {
+    EmojiAtlasCacheKey key;
+    std::vector<std::unique_ptr<EmojiAtlasPage>> pages;
+    std::vector<EmojiAtlasCacheEntry> entries;
+    std::atomic<bool> done;
+    std::thread thread;
+};
+
+// One font of the fallback chain with everything needed to rasterize from it
+struct EmojiManager::EmojiFont {
+    std::string path;
+    const Core::MappedFile* file;   // From FontBlobRegistry
+    void* ftFace;                   // FT_Face
+    uint64_t hash;                  // EmojiAtlasCache::hashFont
+    CodepointTable cmap;            // Unicode cmap: codepoint -> glyph index
+    
+    // OT-SVG glyph documents, parsed lazily (main thread only)
+    SvgGlyphTable svgTable;
+    std::unique_ptr<SvgDocumentCache> svgDocuments;
+    
+    int glyphCacheFace;
+    std::unique_ptr<COLRv1Renderer> renderer;
+};
+
+static int nextPowerOf2(int n) {
+    int p = 1;
+    while (p < n) p *= 2;
+    return p;
+}
+
 EmojiManager::EmojiManager()
     : m_fontSize(18.0f)
-    , m_textureID(nullptr)
-    , m_atlasWidth(0)
-    , m_atlasHeight(0)
-    , m_ftFace(nullptr)
+    , m_pixelSize(0)
+    , m_maxPageSize(MAX_PAGE_SIZE)
+    , m_memoryBudget(0)
+    , m_frame(1)
+    , m_evictionQueueReady(false)
+    , m_targetFontSize(18.0f)
+    , m_drawScale(1.0f)
+    , m_stats{}
+    , m_fontHash(0)
+    , m_atlasDirty(false)
+    , m_glyphCacheBudget(DEFAULT_GLYPH_CACHE_BYTES)
+    , m_resampler(std::make_unique<BitmapResampler>())
     , m_ftLibrary(nullptr)
 {
 }
 
 EmojiManager::~EmojiManager() {
-    if (m_textureID) {
-        GLuint texID = (GLuint)(uintptr_t)m_textureID;
-        glDeleteTextures(1, &texID);
+    if (m_rebuild) {
+        m_rebuild->thread.join();
+        m_rebuild.reset();
     }
+    finishCacheWrite(true);
+    
+    saveAtlasCache();
+    
+    m_rasterPool.reset();
     
-    if (m_ftFace) {
-        FT_Done_Face((FT_Face)m_ftFace);
+    m_pages.clear();
+    
+    // Faces and cached glyphs all belong to m_ftLibrary
+    for (auto& font : m_fonts) {
+        font->renderer.reset();
+        font->svgDocuments.reset();
+        FT_Done_Face((FT_Face)font->ftFace);
     }
+    m_fonts.clear();
+    m_glyphCache.reset();
     
     if (m_ftLibrary) {
         FT_Done_FreeType((FT_Library)m_ftLibrary);
@@ -57,9 +184,19 @@ EmojiManager::~EmojiManager() {
 }
 
 bool EmojiManager::initialize(const char* fontPath, float fontSize) {
-    m_fontPath = fontPath;
+    return initialize(std::vector<std::string>{fontPath}, fontSize);
+}
+
+bool EmojiManager::initialize(const std::vector<std::string>& fontPaths, float fontSize) {
     m_fontSize = fontSize;
     
+    // Low-end GL 3.3 drivers can have small texture limits
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if (maxTextureSize > 0) {
+        m_maxPageSize = std::min(MAX_PAGE_SIZE, static_cast<int>(maxTextureSize));
+    }
+    
     // Initialize FreeType
     FT_Library library;
     if (FT_Init_FreeType(&library)) {
@@ -68,18 +205,86 @@ bool EmojiManager::initialize(const char* fontPath, float fontSize) {
     }
     m_ftLibrary = library;
     
+    // Layer outlines and strike bitmaps survive font size toggles here
+    m_glyphCache = std::make_unique<GlyphCache>(library, m_glyphCacheBudget / 2);
+    
+    for (const std::string& path : fontPaths) {
+        if (!loadFont(path)) {
+            std::cerr << "EmojiManager: Skipping " << path << "\n";
+        }
+    }
+    if (m_fonts.empty()) {
+        return false;
+    }
+    
+    // Persisted atlases follow every font of the chain, in order. A single
+    // font keeps its own hash.
+    m_fontHash = 0;
+    for (size_t i = 0; i < m_fonts.size(); ++i) {
+        m_fontHash = i == 0 ? m_fonts[i]->hash : (m_fontHash ^ m_fonts[i]->hash) * 0x9E3779B97F4A7C15ull;
+    }
+    
+    resolveGlyphs();
+    int indexedCount = static_cast<int>(m_glyphs.size());
+    
+    std::cout << "EmojiManager: Indexed " << indexedCount << " emoji glyphs from " << m_fonts.size() << " fonts\n";
+    
+    m_targetFontSize = m_fontSize;
+    
+    if (indexedCount > 0) {
+        std::vector<GlyphRasterFont> rasterFonts;
+        for (const auto& font : m_fonts) {
+            rasterFonts.push_back({font->file, font->svgDocuments ? &font->svgTable : nullptr});
+        }
+        m_rasterPool = std::make_unique<GlyphRasterPool>(rasterFonts, m_glyphCacheBudget / 2);
+        buildAtlas();
+        return true;
+    }
+    
+    return false;
+}
+
+bool EmojiManager::loadFont(const std::string& path) {
+    auto font = std::make_unique<EmojiFont>();
+    font->path = path;
+    
+    // Mapped once per process; the main face and every raster worker read from it
+    font->file = FontBlobRegistry::get().acquire(path);
+    if (!font->file) {
+        std::cerr << "Failed to map font: " << path << "\n";
+        return false;
+    }
+    
     // Load font face
-    FT_Face face;
-    if (FT_New_Face(library, fontPath, 0, &face)) {
-        std::cerr << "Failed to load font: " << fontPath << "\n";
+    FT_Face face = (FT_Face)FontBlobRegistry::newFace(m_ftLibrary, *font->file);
+    if (!face) {
+        std::cerr << "Failed to load font: " << path << "\n";
         return false;
     }
-    m_ftFace = face;
+    font->ftFace = face;
     
-    std::cout << "EmojiManager: Font info:\n";
+    if (FT_Select_Charmap(face, FT_ENCODING_UNICODE) != 0) {
+        std::cerr << "EmojiManager: " << path << " has no Unicode cmap\n";
+        FT_Done_Face(face);
+        return false;
+    }
+    
+    // Identify the font so persisted atlases follow font updates
+    font->hash = EmojiAtlasCache::hashFont(font->file->data(), font->file->size());
+    
+    // OT-SVG fonts: documents are parsed on first use, straight from the mapped bytes
+    if (font->svgTable.load(font->file->data(), font->file->size())) {
+        font->svgDocuments = std::make_unique<SvgDocumentCache>(&font->svgTable);
+    }
+    
+    font->glyphCacheFace = m_glyphCache->addFace(*font->file);
+    
+    std::cout << "EmojiManager: Font info for " << path << ":\n";
     std::cout << "  Family: " << (face->family_name ? face->family_name : "N/A") << "\n";
     std::cout << "  Num fixed sizes: " << face->num_fixed_sizes << "\n";
     std::cout << "  Has color: " << ((face->face_flags & FT_FACE_FLAG_COLOR) ? "yes" : "no") << "\n";
+    std::cout << "  Color formats: " << COLRv1Renderer::describeColorFormats(COLRv1Renderer::detectColorFormats(face))
+              << "\n";
     
     // Check for fixed sizes (color emoji fonts usually have these)
     if (face->num_fixed_sizes > 0) {
@@ -88,242 +293,706 @@ bool EmojiManager::initialize(const char* fontPath, float fontSize) {
             std::cout << "  [" << i << "] " << face->available_sizes[i].width 
                       << "x" << face->available_sizes[i].height << "px\n";
         }
-        
-        // Use the fixed size closest to requested fontSize
-        int bestSize = 0;
-        int minDiff = std::abs(face->available_sizes[0].height - static_cast<int>(fontSize));
-        for (int i = 1; i < face->num_fixed_sizes; i++) {
-            int diff = std::abs(face->available_sizes[i].height - static_cast<int>(fontSize));
-            if (diff < minDiff) {
-                minDiff = diff;
-                bestSize = i;
-            }
-        }
-        
-        if (FT_Select_Size(face, bestSize) == 0) {
-            std::cout << "EmojiManager: Selected fixed size " << bestSize << ": " 
-                      << face->available_sizes[bestSize].height << "px\n";
-            m_fontSize = face->available_sizes[bestSize].height; // Use actual size
-        } else {
-            std::cerr << "Failed to select fixed size\n";
-            FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(fontSize));
-        }
-    } else {
-        // Set font size
-        FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(fontSize));
     }
     
-    std::cout << "EmojiManager: Extracting emoji glyphs from font...\n";
+    // Strikes are scaled to the atlas size, so the requested size stands
+    GlyphRasterPool::configureFace(face, pixelSizeFor(m_fontSize));
+    
+    // Keep the cmap for fallback resolution, one pass over it, so glyphs
+    // are resolved without asking FreeType per codepoint
+    size_t covered = 0;
+    FT_UInt glyphIndex = 0;
+    for (FT_ULong codepoint = FT_Get_First_Char(face, &glyphIndex); glyphIndex != 0;
+         codepoint = FT_Get_Next_Char(face, codepoint, &glyphIndex)) {
+        font->cmap.insert(static_cast<uint32_t>(codepoint), glyphIndex);
+        covered++;
+    }
+    std::cout << "EmojiManager: " << path << " maps " << covered << " codepoints\n";
     
-    // Extract SVG glyphs for our emoji ranges
-    int extractedCount = 0;
-    for (const auto& range : EMOJI_RANGES) {
+    m_fonts.push_back(std::move(font));
+    return true;
+}
+
+void EmojiManager::resolveGlyphs() {
+    // Each emoji codepoint is resolved once, to the first font in chain
+    // order whose cmap has it; m_lookup then answers getEmoji() without
+    // looking at the fonts again, however many there are
+    m_glyphs.clear();
+    m_lookup.clear();
+    std::vector<size_t> perFont(m_fonts.size(), 0);
+    
+    for (const auto& range : EMOJI_PROPERTY_RANGES) {
         for (uint32_t codepoint = range.first; codepoint <= range.second; ++codepoint) {
-            // Check if this codepoint has a glyph in the font
-            FT_UInt glyphIndex = FT_Get_Char_Index(face, codepoint);
-            if (glyphIndex == 0) {
-                continue;
-            }
-            
-            // Try to extract SVG data
-            std::string svgData;
-            if (extractSVG(codepoint, svgData)) {
-                EmojiGlyph emoji;
+            for (size_t i = 0; i < m_fonts.size(); ++i) {
+                int glyphIndex = m_fonts[i]->cmap.find(codepoint);
+                if (glyphIndex < 0) {
+                    continue;
+                }
+                
+                EmojiGlyph emoji = {};
                 emoji.codepoint = codepoint;
-                m_emojiGlyphs[codepoint] = emoji;
-                extractedCount++;
+                emoji.glyphIndex = static_cast<uint32_t>(glyphIndex);
+                emoji.font = static_cast<int>(i);
+                m_lookup.insert(emoji.codepoint, static_cast<uint32_t>(m_glyphs.size()));
+                m_glyphs.push_back(emoji);
+                perFont[i]++;
+                break;
             }
         }
     }
     
-    std::cout << "EmojiManager: Extracted " << extractedCount << " emoji glyphs\n";
+    for (size_t i = 0; i < m_fonts.size(); ++i) {
+        std::cout << "EmojiManager: " << perFont[i] << " emoji from " << m_fonts[i]->path << "\n";
+    }
+}
+
+void EmojiManager::buildAtlas() {
+    resetAtlas();
+    
+    // Warm start: reuse previously rasterized pages for this font and size
+    if (!loadAtlasCache()) {
+        // Start small and let the first page grow as glyphs arrive
+        m_pages.clear();
+        addPage();
+    }
+    updateAtlasStats();
     
-    if (extractedCount > 0) {
-        buildAtlas();
-        return true;
+    for (auto& page : m_pages) {
+        page->upload();
     }
     
-    return false;
+    // One line per build; pages, grows and cache loads stay quiet
+    std::cout << "EmojiManager: Atlas at " << m_pixelSize << " px: " << m_pages.size() << " pages, "
+              << m_stats.residentGlyphs << " emojis from cache, " << GetCompositeSpanKernelName() << " kernel\n";
 }
 
-bool EmojiManager::extractSVG(uint32_t codepoint, std::string& svgData) {
-    FT_Face face = (FT_Face)m_ftFace;
-    FT_UInt glyphIndex = FT_Get_Char_Index(face, codepoint);
+void EmojiManager::resetAtlas() {
+    m_pixelSize = pixelSizeFor(m_fontSize);
     
-    if (glyphIndex == 0) {
-        return false;
+    for (auto& font : m_fonts) {
+        FT_Face face = (FT_Face)font->ftFace;
+        GlyphRasterPool::configureFace(face, m_pixelSize);
+        
+        // Create COLRv1 renderer for emoji rasterization
+        font->renderer = std::make_unique<COLRv1Renderer>(m_pixelSize, m_pixelSize);
+        font->renderer->setSvgDocuments(font->svgDocuments.get());
+        font->renderer->setGlyphCache(m_glyphCache.get(), font->glyphCacheFace);
     }
     
-    // Load the glyph
-    if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT)) {
+    // Nothing is resident in a fresh atlas, but every glyph already knows
+    // its size so text layout is stable before it is rasterized
+    for (EmojiGlyph& emoji : m_glyphs) {
+        emoji.width = m_pixelSize;
+        emoji.height = m_pixelSize;
+        emoji.advance = m_pixelSize;
+        emoji.resident = false;
+    }
+    m_stats.residentGlyphs = 0;
+    m_atlasDirty = false;
+}
+
+EmojiAtlasPage& EmojiManager::addPage() {
+    int size = nextPowerOf2(std::max(MIN_ATLAS_SIZE, m_pixelSize + ATLAS_PADDING));
+    size = std::min(size, m_maxPageSize);
+    m_pages.push_back(std::make_unique<EmojiAtlasPage>(size, size));
+    return *m_pages.back();
+}
+
+void EmojiManager::updateAtlasStats() {
+    int64_t liveArea = 0;
+    int64_t totalArea = 0;
+    m_stats.atlasBytes = 0;
+    for (const auto& page : m_pages) {
+        liveArea += page->getLiveArea();
+        totalArea += static_cast<int64_t>(page->getWidth()) * page->getHeight();
+        m_stats.atlasBytes += page->getBytes();
+    }
+    m_stats.atlasPages = m_pages.size();
+    m_stats.atlasOccupancy = totalArea > 0 ? static_cast<float>(liveArea) / static_cast<float>(totalArea) : 0.0f;
+}
+
+EmojiAtlasCacheKey EmojiManager::cacheKey(int pixelSize) const {
+    EmojiAtlasCacheKey key;
+    key.fontHash = m_fontHash;
+    key.pixelSize = static_cast<uint32_t>(pixelSize);
+    key.rendererVersion = COLRv1Renderer::getRenderVersion();
+    return key;
+}
+
+bool EmojiManager::loadAtlasCache() {
+    if (m_fontHash == 0) {
         return false;
     }
     
-    // Check if glyph has SVG document
-    FT_GlyphSlot slot = face->glyph;
+    std::vector<std::unique_ptr<EmojiAtlasPage>> pages;
+    std::vector<EmojiAtlasCacheEntry> entries;
+    if (!m_diskCache.load(cacheKey(m_pixelSize), pages, entries)) {
+        return false;
+    }
     
-    // For NotoColorEmoji, we might need to use the CBDT/CBLC tables instead of SVG
-    // For now, we'll use a fallback approach: render using FreeType's bitmap
-    // This is a simplified implementation - full SVG extraction would require
-    // parsing the SVG table directly
+    return restoreAtlas(pages, entries);
+}
+
+bool EmojiManager::restoreAtlas(std::vector<std::unique_ptr<EmojiAtlasPage>>& pages,
+                                const std::vector<EmojiAtlasCacheEntry>& entries) {
+    size_t bytes = 0;
+    for (const auto& page : pages) {
+        if (page->getWidth() > m_maxPageSize || page->getHeight() > m_maxPageSize) {
+            std::cout << "EmojiManager: Cached atlas pages exceed this GPU's texture size\n";
+            return false;
+        }
+        bytes += page->getBytes();
+    }
+    if (m_memoryBudget != 0 && bytes > m_memoryBudget) {
+        std::cout << "EmojiManager: Cached atlas exceeds the memory budget\n";
+        return false;
+    }
+    m_pages = std::move(pages);
     
-    // Fallback: just mark it as available, we'll rasterize using LunaSVG placeholder
-    svgData = ""; // Placeholder
+    size_t restored = 0;
+    for (const EmojiAtlasCacheEntry& entry : entries) {
+        EmojiGlyph* found = findGlyph(entry.codepoint);
+        if (!found || found->glyphIndex != entry.glyphIndex || entry.page >= m_pages.size()) {
+            continue;
+        }
+        
+        EmojiGlyph& emoji = *found;
+        emoji.page = static_cast<int>(entry.page);
+        emoji.atlasX = entry.atlasX;
+        emoji.atlasY = entry.atlasY;
+        emoji.x0 = static_cast<float>(entry.inkX);
+        emoji.y0 = static_cast<float>(entry.inkY);
+        emoji.x1 = static_cast<float>(entry.inkX + entry.inkWidth);
+        emoji.y1 = static_cast<float>(entry.inkY + entry.inkHeight);
+        updateUVs(emoji);
+        emoji.resident = true;
+        if (entry.inkWidth > 0) {
+            m_pages[emoji.page]->retain({entry.atlasX, entry.atlasY, entry.inkWidth + ATLAS_PADDING,
+                                         entry.inkHeight + ATLAS_PADDING});
+        }
+        restored++;
+    }
+    m_stats.residentGlyphs = restored;
     return true;
 }
 
-void EmojiManager::buildAtlas() {
-    std::cout << "EmojiManager: Building texture atlas...\n";
+std::vector<EmojiAtlasCacheEntry> EmojiManager::collectCacheEntries() const {
+    std::vector<EmojiAtlasCacheEntry> entries;
+    entries.reserve(m_stats.residentGlyphs);
+    for (const EmojiGlyph& emoji : m_glyphs) {
+        if (emoji.resident) {
+            EmojiAtlasCacheEntry entry;
+            entry.codepoint = emoji.codepoint;
+            entry.glyphIndex = emoji.glyphIndex;
+            entry.page = static_cast<uint32_t>(emoji.page);
+            entry.atlasX = emoji.atlasX;
+            entry.atlasY = emoji.atlasY;
+            entry.inkX = static_cast<int32_t>(emoji.x0);
+            entry.inkY = static_cast<int32_t>(emoji.y0);
+            entry.inkWidth = static_cast<int32_t>(emoji.x1 - emoji.x0);
+            entry.inkHeight = static_cast<int32_t>(emoji.y1 - emoji.y0);
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+
+void EmojiManager::saveAtlasCache() {
+    if (!m_atlasDirty || m_fontHash == 0) {
+        return;
+    }
+    
+    if (m_diskCache.store(cacheKey(m_pixelSize), m_pages, collectCacheEntries())) {
+        m_atlasDirty = false;
+    }
+}
+
+void EmojiManager::saveAtlasCacheAsync() {
+    if (!m_atlasDirty || m_fontHash == 0) {
+        return;
+    }
+    
+    // Size changes faster than a write are rare; the older one finishes first
+    finishCacheWrite(true);
+    
+    // The pages are about to be replaced, so the writer takes them as they are
+    auto job = std::make_unique<CacheWriteJob>();
+    job->key = cacheKey(m_pixelSize);
+    job->entries = collectCacheEntries();
+    job->pages = std::move(m_pages);
+    job->done = false;
+    m_pages.clear();
+    m_atlasDirty = false;
+    
+    CacheWriteJob* raw = job.get();
+    job->thread = std::thread([this, raw]() {
+        m_diskCache.store(raw->key, raw->pages, raw->entries);
+        raw->done.store(true, std::memory_order_release);
+    });
+    m_cacheWrite = std::move(job);
+}
+
+void EmojiManager::finishCacheWrite(bool wait) {
+    if (!m_cacheWrite || (!wait && !m_cacheWrite->done.load(std::memory_order_acquire))) {
+        return;
+    }
+    m_cacheWrite->thread.join();
+    m_cacheWrite.reset();
+}
+
+void EmojiManager::updateUVs(EmojiGlyph& emoji) {
+    const EmojiAtlasPage& page = *m_pages[emoji.page];
+    float width = static_cast<float>(page.getWidth());
+    float height = static_cast<float>(page.getHeight());
+    emoji.u0 = emoji.atlasX / width;
+    emoji.v0 = emoji.atlasY / height;
+    emoji.u1 = (emoji.atlasX + (emoji.x1 - emoji.x0)) / width;
+    emoji.v1 = (emoji.atlasY + (emoji.y1 - emoji.y0)) / height;
+}
+
+size_t EmojiManager::getAtlasBytes() const {
+    size_t bytes = 0;
+    for (const auto& page : m_pages) {
+        bytes += page->getBytes();
+    }
+    return bytes;
+}
+
+bool EmojiManager::withinBudget(size_t extraBytes) const {
+    return m_memoryBudget == 0 || getAtlasBytes() + extraBytes <= m_memoryBudget;
+}
+
+bool EmojiManager::allocateOnPage(int page, int width, int height, int& x, int& y) {
+    EmojiAtlasPage& candidate = *m_pages[page];
+    bool grown = false;
+    bool placed = candidate.allocate(width, height, x, y);
+    while (!placed && candidate.canGrow(m_maxPageSize) && withinBudget(candidate.getGrowthBytes())) {
+        candidate.grow();
+        grown = true;
+        placed = candidate.allocate(width, height, x, y);
+    }
+    
+    // Growing a page rescales the UVs of everything already on it
+    if (grown) {
+        for (EmojiGlyph& emoji : m_glyphs) {
+            if (emoji.resident && emoji.page == page) {
+                updateUVs(emoji);
+            }
+        }
+    }
+    
+    return placed;
+}
+
+bool EmojiManager::allocateRect(int width, int height, int& page, int& x, int& y) {
+    // Space already paid for comes first: freed slots and skyline on every page
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+        if (m_pages[i]->allocate(width, height, x, y)) {
+            page = static_cast<int>(i);
+            return true;
+        }
+    }
     
-    FT_Face face = (FT_Face)m_ftFace;
+    // Then grow pages, and add one, while the budget allows
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+        if (allocateOnPage(static_cast<int>(i), width, height, x, y)) {
+            page = static_cast<int>(i);
+            return true;
+        }
+    }
     
-    // Set a larger pixel size for better quality
-    int pixelSize = std::max(32, static_cast<int>(m_fontSize * 2));
-    FT_Set_Pixel_Sizes(face, 0, pixelSize);
-    std::cout << "EmojiManager: Using pixel size: " << pixelSize << "\n";
+    int newPageSize = nextPowerOf2(std::max(MIN_ATLAS_SIZE, m_pixelSize + ATLAS_PADDING));
+    size_t newPageBytes = static_cast<size_t>(newPageSize) * newPageSize * 4;
+    if (m_pages.empty() || withinBudget(newPageBytes)) {
+        addPage();
+        int last = static_cast<int>(m_pages.size()) - 1;
+        if (allocateOnPage(last, width, height, x, y)) {
+            page = last;
+            return true;
+        }
+        m_pages.pop_back();
+    }
+    
+    // Out of budget: recycle the least recently drawn glyphs
+    for (int freed = evictLeastRecentlyUsed(); freed >= 0; freed = evictLeastRecentlyUsed()) {
+        if (m_pages[freed]->allocate(width, height, x, y)) {
+            page = freed;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+int EmojiManager::evictLeastRecentlyUsed() {
+    if (!m_evictionQueueReady) {
+        // Oldest at the back; glyphs drawn this frame are never candidates
+        m_evictionQueue.clear();
+        for (EmojiGlyph& emoji : m_glyphs) {
+            if (emoji.resident && emoji.x1 > emoji.x0 && emoji.lastUsedFrame < m_frame) {
+                m_evictionQueue.push_back(&emoji);
+            }
+        }
+        std::sort(m_evictionQueue.begin(), m_evictionQueue.end(),
+                  [](const EmojiGlyph* a, const EmojiGlyph* b) { return a->lastUsedFrame > b->lastUsedFrame; });
+        m_evictionQueueReady = true;
+    }
+    
+    while (!m_evictionQueue.empty()) {
+        EmojiGlyph& emoji = *m_evictionQueue.back();
+        m_evictionQueue.pop_back();
+        if (!emoji.resident || emoji.lastUsedFrame >= m_frame) {
+            continue;
+        }
+        
+        AtlasRect rect = {emoji.atlasX, emoji.atlasY,
+                          static_cast<int>(emoji.x1 - emoji.x0) + ATLAS_PADDING,
+                          static_cast<int>(emoji.y1 - emoji.y0) + ATLAS_PADDING};
+        m_pages[emoji.page]->release(rect);
+        
+        emoji.resident = false;
+        m_stats.residentGlyphs--;
+        m_stats.evictions++;
+        m_atlasDirty = true;
+        return emoji.page;
+    }
     
-    // Check if face has COLR table
-    FT_Color* palette = nullptr;
-    FT_UShort num_palette_entries = 0;
-    FT_Palette_Data palette_data;
+    return -1;
+}
+
+void EmojiManager::markUsed(const EmojiGlyph* emoji) {
+    // Glyphs are owned by m_glyphs; callers only get const views
+    const_cast<EmojiGlyph*>(emoji)->lastUsedFrame = m_frame;
+}
+
+bool EmojiManager::placeGlyph(EmojiGlyph& emoji, const uint8_t* pixels) {
+    // Trim fully transparent borders, only the ink goes into the atlas
+    int left = m_pixelSize, top = m_pixelSize, right = 0, bottom = 0;
+    for (int row = 0; row < m_pixelSize; ++row) {
+        const uint8_t* line = pixels + static_cast<size_t>(row) * m_pixelSize * 4;
+        for (int col = 0; col < m_pixelSize; ++col) {
+            if (line[col * 4 + 3] != 0) {
+                left = std::min(left, col);
+                right = std::max(right, col + 1);
+                top = std::min(top, row);
+                bottom = std::max(bottom, row + 1);
+            }
+        }
+    }
     
-    bool has_colr = FT_Palette_Select(face, 0, &palette) == 0;
-    if (has_colr) {
-        std::cout << "EmojiManager: Font has COLR/CPAL tables\n";
-        FT_Palette_Data_Get(face, &palette_data);
-        std::cout << "EmojiManager: Number of palettes: " << palette_data.num_palettes << "\n";
+    if (right <= left || bottom <= top) {
+        // Nothing visible: resident, but no quad to draw
+        emoji.x0 = emoji.y0 = emoji.x1 = emoji.y1 = 0.0f;
+        emoji.page = 0;
+        emoji.atlasX = emoji.atlasY = 0;
+        updateUVs(emoji);
+        emoji.resident = true;
+        return true;
     }
     
-    // Calculate required atlas size
-    int emojiSize = pixelSize;
-    int padding = 2;
-    int glyphsPerRow = 16;
-    int numGlyphs = m_emojiGlyphs.size();
-    int numRows = (numGlyphs + glyphsPerRow - 1) / glyphsPerRow;
+    int inkWidth = right - left;
+    int inkHeight = bottom - top;
     
-    m_atlasWidth = glyphsPerRow * (emojiSize + padding);
-    m_atlasHeight = numRows * (emojiSize + padding);
+    int page, x, y;
+    if (!allocateRect(inkWidth + ATLAS_PADDING, inkHeight + ATLAS_PADDING, page, x, y)) {
+        return false;
+    }
     
-    // Round up to power of 2 for better GPU compatibility
-    auto nextPowerOf2 = [](int n) {
-        int p = 1;
-        while (p < n) p *= 2;
-        return p;
-    };
-    m_atlasWidth = nextPowerOf2(m_atlasWidth);
-    m_atlasHeight = nextPowerOf2(m_atlasHeight);
+    // This copy stays: the rect is sized to the ink, which isn't known until
+    // the glyph is rendered, so glyphs can't be drawn into the page through
+    // an AtlasView the way the raster pool draws into its slab. Only the
+    // trimmed rows are copied, once per glyph.
+    const uint8_t* ink = pixels + (static_cast<size_t>(top) * m_pixelSize + left) * 4;
+    m_pages[page]->write(x, y, inkWidth, inkHeight, ink, static_cast<size_t>(m_pixelSize) * 4);
+    
+    emoji.x0 = static_cast<float>(left);
+    emoji.y0 = static_cast<float>(top);
+    emoji.x1 = static_cast<float>(right);
+    emoji.y1 = static_cast<float>(bottom);
+    emoji.page = page;
+    emoji.atlasX = x;
+    emoji.atlasY = y;
+    updateUVs(emoji);
+    emoji.resident = true;
+    emoji.lastUsedFrame = m_frame;
+    return true;
+}
+
+void EmojiManager::update() {
+    // Swap in a finished background rebuild before anything else touches the atlas
+    if (m_rebuild && m_rebuild->done.load(std::memory_order_acquire)) {
+        finishRebuild();
+    }
+    finishCacheWrite(false);
     
-    std::cout << "EmojiManager: Atlas size: " << m_atlasWidth << "x" << m_atlasHeight << "\n";
+    if (!m_pending.empty()) {
+        rasterizePending();
+    }
     
-    // Allocate RGBA atlas
-    m_atlasData.resize(m_atlasWidth * m_atlasHeight * 4, 0);
+    // Push whatever changed since the last frame to the GPU
+    for (auto& page : m_pages) {
+        page->upload();
+    }
+    
+    // Everything drawn from here on belongs to the next frame
+    m_frame++;
+}
+
+void EmojiManager::rasterizePending() {
+    std::vector<EmojiGlyph*> batch;
+    batch.reserve(m_pending.size());
+    for (EmojiGlyph* emoji : m_pending) {
+        emoji->queued = false;
+        if (!emoji->resident) {
+            batch.push_back(emoji);
+        }
+    }
+    m_pending.clear();
+    m_evictionQueueReady = false;
     
-    // Render each emoji into the atlas
-    int x = 0, y = 0;
     int rendered = 0;
     int skipped = 0;
     
-    // Create COLRv1 renderer for emoji rasterization
-    COLRv1Renderer renderer(emojiSize, emojiSize);
-    
-    for (auto& pair : m_emojiGlyphs) {
-        uint32_t codepoint = pair.first;
-        EmojiGlyph& emoji = pair.second;
-        
-        FT_UInt glyphIndex = FT_Get_Char_Index(face, codepoint);
-        if (glyphIndex == 0) {
-            skipped++;
-            continue;
+    // A running rebuild owns the raster pool
+    if (!m_rebuild && GlyphRasterPool::workerCountFor(batch.size()) > 1) {
+        // Large batches (first frame, size changes) rasterize in parallel.
+        // Glyphs are still packed in queue order, so the atlas is
+        // byte-identical to the serial path. Workers render straight into
+        // the batch slab; placeGlyph() then trims each cell and copies the
+        // ink into the page.
+        std::vector<GlyphRasterJob> jobs;
+        jobs.reserve(batch.size());
+        for (EmojiGlyph* emoji : batch) {
+            jobs.push_back({emoji->glyphIndex, emoji->codepoint, static_cast<uint32_t>(emoji->font)});
         }
         
-        // Use COLRv1 renderer to render the glyph
-        if (!renderer.renderGlyph(m_ftFace, glyphIndex, codepoint)) {
-            skipped++;
-            continue;
-        }
+        GlyphRasterBatch results;
+        m_rasterPool->rasterize(jobs, m_fontSize, m_pixelSize, results);
         
-        // Copy rendered emoji to atlas
-        const std::vector<uint8_t>& emoji_buffer = renderer.getBuffer();
-        for (int row = 0; row < emojiSize && y + row < m_atlasHeight; ++row) {
-            for (int col = 0; col < emojiSize && x + col < m_atlasWidth; ++col) {
-                int atlasIdx = ((y + row) * m_atlasWidth + (x + col)) * 4;
-                int bufferIdx = (row * emojiSize + col) * 4;
-                
-                m_atlasData[atlasIdx + 0] = emoji_buffer[bufferIdx + 0];
-                m_atlasData[atlasIdx + 1] = emoji_buffer[bufferIdx + 1];
-                m_atlasData[atlasIdx + 2] = emoji_buffer[bufferIdx + 2];
-                m_atlasData[atlasIdx + 3] = emoji_buffer[bufferIdx + 3];
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (results.rendered[i] && placeGlyph(*batch[i], results.getPixels(i))) {
+                rendered++;
+            } else {
+                skipped++;
             }
         }
-        
-        // Calculate UV coordinates
-        emoji.u0 = static_cast<float>(x) / m_atlasWidth;
-        emoji.v0 = static_cast<float>(y) / m_atlasHeight;
-        emoji.u1 = static_cast<float>(x + emojiSize) / m_atlasWidth;
-        emoji.v1 = static_cast<float>(y + emojiSize) / m_atlasHeight;
-        emoji.width = emojiSize;
-        emoji.height = emojiSize;
-        emoji.advance = emojiSize;
-        
-        // Move to next position
-        x += emojiSize + padding;
-        if (x + emojiSize >= m_atlasWidth) {
-            x = 0;
-            y += emojiSize + padding;
+    } else {
+        for (EmojiGlyph* emoji : batch) {
+            // Rendered into the renderer's buffer; placeGlyph() trims it and
+            // copies the ink into the page
+            EmojiFont& font = *m_fonts[emoji->font];
+            if (font.renderer->renderGlyph(font.ftFace, emoji->glyphIndex) &&
+                placeGlyph(*emoji, font.renderer->getBuffer().data())) {
+                rendered++;
+            } else {
+                skipped++;
+            }
         }
-        
-        rendered++;
     }
     
-    std::cout << "EmojiManager: Rendered " << rendered << " emojis to atlas (skipped: " << skipped << ")\n";
+    m_stats.residentGlyphs += rendered;
+    m_stats.pendingGlyphs = 0;
+    updateAtlasStats();
+    
+    if (rendered > 0) {
+        m_atlasDirty = true;
+    }
     
-    // Create OpenGL texture
-    createTexture();
+    if (skipped > 0) {
+        std::cerr << "EmojiManager: Failed to rasterize " << skipped << " emojis\n";
+    }
 }
 
-void EmojiManager::createTexture() {
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
+void EmojiManager::setFontSize(float newSize) {
+    if (std::abs(newSize - m_targetFontSize) < 0.1f) {
+        return; // No significant change
+    }
     
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    m_targetFontSize = newSize;
     
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_atlasWidth, m_atlasHeight,
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, m_atlasData.data());
+    if (m_fonts.empty()) {
+        m_fontSize = newSize;
+        return;
+    }
     
-    m_textureID = (void*)(uintptr_t)texID;
+    // Keep drawing the current atlas, scaled to the new size, until the
+    // rebuild is swapped in by update(). A rebuild already in flight is
+    // restarted for the latest size when it finishes.
+    m_drawScale = static_cast<float>(pixelSizeFor(newSize)) / static_cast<float>(m_pixelSize);
+    if (!m_rebuild) {
+        startRebuild(newSize);
+    }
+}
+
+void EmojiManager::startRebuild(float fontSize) {
+    auto job = std::make_unique<RebuildJob>();
+    job->fontSize = fontSize;
+    job->pixelSize = pixelSizeFor(fontSize);
+    job->cacheLoaded = false;
+    job->done = false;
+    
+    // Glyphs on screen now are the ones the new atlas needs first
+    for (const EmojiGlyph& emoji : m_glyphs) {
+        if (emoji.resident && emoji.lastUsedFrame + 1 >= m_frame) {
+            job->jobs.push_back({emoji.glyphIndex, emoji.codepoint, static_cast<uint32_t>(emoji.font)});
+        }
+    }
     
-    std::cout << "EmojiManager: Created texture ID: " << texID << "\n";
+    RebuildJob* raw = job.get();
+    job->thread = std::thread([this, raw]() { runRebuild(*raw); });
+    m_rebuild = std::move(job);
 }
 
-void EmojiManager::setFontSize(float newSize) {
-    if (std::abs(newSize - m_fontSize) < 0.1f) {
-        return; // No significant change
+void EmojiManager::runRebuild(RebuildJob& job) {
+    // Runs on the job thread: only the disk cache, the raster pool and the
+    // job itself are touched here
+    if (m_fontHash != 0) {
+        job.cacheLoaded = m_diskCache.load(cacheKey(job.pixelSize), job.cachedPages, job.cachedEntries);
     }
     
-    m_fontSize = newSize;
+    if (job.cacheLoaded) {
+        std::unordered_set<uint32_t> cached;
+        for (const EmojiAtlasCacheEntry& entry : job.cachedEntries) {
+            cached.insert(entry.codepoint);
+        }
+        job.jobs.erase(std::remove_if(job.jobs.begin(), job.jobs.end(),
+                                      [&](const GlyphRasterJob& j) { return cached.count(j.codepoint) > 0; }),
+                       job.jobs.end());
+    }
     
-    // Re-initialize with new size
-    if (m_ftFace) {
-        FT_Face face = (FT_Face)m_ftFace;
-        FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(newSize));
-        buildAtlas();
+    m_rasterPool->rasterize(job.jobs, job.fontSize, job.pixelSize, job.results);
+    job.done.store(true, std::memory_order_release);
+}
+
+void EmojiManager::finishRebuild() {
+    std::unique_ptr<RebuildJob> job = std::move(m_rebuild);
+    job->thread.join();
+    
+    if (std::abs(job->fontSize - m_targetFontSize) >= 0.1f) {
+        // Superseded by another setFontSize() while it ran
+        if (std::abs(m_targetFontSize - m_fontSize) >= 0.1f) {
+            startRebuild(m_targetFontSize);
+        } else {
+            m_drawScale = 1.0f;
+        }
+        return;
+    }
+    
+    // Keep this size's atlas around for the next time it is used; only the
+    // hand-off happens here, the file is written on the writer thread
+    saveAtlasCacheAsync();
+    
+    // Glyphs drawn while the job ran may be missing from it
+    std::vector<EmojiGlyph*> visible;
+    for (EmojiGlyph& emoji : m_glyphs) {
+        if (emoji.resident && emoji.lastUsedFrame + 1 >= m_frame) {
+            visible.push_back(&emoji);
+        }
+    }
+    
+    m_fontSize = job->fontSize;
+    resetAtlas();
+    if (!job->cacheLoaded || !restoreAtlas(job->cachedPages, job->cachedEntries)) {
+        m_pages.clear();
+        addPage();
+    }
+    
+    int rendered = 0;
+    for (size_t i = 0; i < job->jobs.size(); ++i) {
+        EmojiGlyph& emoji = *findGlyph(job->jobs[i].codepoint);
+        if (!emoji.resident && job->results.rendered[i] && placeGlyph(emoji, job->results.getPixels(i))) {
+            rendered++;
+        }
+    }
+    m_stats.residentGlyphs += rendered;
+    if (rendered > 0) {
+        m_atlasDirty = true;
+    }
+    
+    for (EmojiGlyph* emoji : visible) {
+        if (!emoji->resident && !emoji->queued) {
+            emoji->queued = true;
+            m_pending.push_back(emoji);
+        }
+    }
+    m_stats.pendingGlyphs = m_pending.size();
+    updateAtlasStats();
+    
+    m_drawScale = 1.0f;
+    std::cout << "EmojiManager: Swapped in atlas for size " << m_fontSize << " (" << m_pixelSize << " px, "
+              << m_pages.size() << " pages, " << m_stats.residentGlyphs << " emojis)\n";
+}
+
+const EmojiGlyph* EmojiManager::getEmoji(uint32_t codepoint) {
+    EmojiGlyph* found = findGlyph(codepoint);
+    if (!found) {
+        return nullptr;
+    }
+    
+    EmojiGlyph& emoji = *found;
+    if (emoji.resident) {
+        m_stats.hits++;
+    } else {
+        m_stats.misses++;
+        if (!emoji.queued) {
+            emoji.queued = true;
+            m_pending.push_back(&emoji);
+            m_stats.pendingGlyphs = m_pending.size();
+        }
     }
+    
+    return &emoji;
 }
 
-const EmojiGlyph* EmojiManager::getEmoji(uint32_t codepoint) const {
-    auto it = m_emojiGlyphs.find(codepoint);
-    if (it != m_emojiGlyphs.end()) {
-        return &it->second;
+bool EmojiManager::rasterizeGlyph(uint32_t codepoint, int pixelSize, std::vector<uint8_t>& pixels) {
+    const EmojiGlyph* emoji = findGlyph(codepoint);
+    if (!emoji || m_pixelSize == 0 || pixelSize <= 0) {
+        return false;
     }
-    return nullptr;
+    
+    // Render at the atlas size the face is configured for, then resample
+    EmojiFont& font = *m_fonts[emoji->font];
+    if (!font.renderer->renderGlyph(font.ftFace, emoji->glyphIndex)) {
+        return false;
+    }
+    
+    const uint8_t* rendered = font.renderer->getBuffer().data();
+    size_t renderedBytes = static_cast<size_t>(m_pixelSize) * m_pixelSize * 4;
+    if (pixelSize == m_pixelSize) {
+        pixels.assign(rendered, rendered + renderedBytes);
+    } else if (pixelSize > m_pixelSize) {
+        upscaleGlyph(rendered, m_pixelSize, pixels, pixelSize);
+    } else {
+        // The renderer hands out straight alpha and the resampler averages
+        // premultiplied pixels, so transparent ones don't darken the edges
+        m_resampleBuffer.resize(renderedBytes);
+        for (size_t i = 0; i < renderedBytes; i += 4) {
+            uint32_t a = rendered[i + 3];
+            for (int c = 0; c < 3; ++c) {
+                m_resampleBuffer[i + c] = static_cast<uint8_t>((rendered[i + c] * a + 127) / 255);
+            }
+            m_resampleBuffer[i + 3] = static_cast<uint8_t>(a);
+        }
+        
+        pixels.resize(static_cast<size_t>(pixelSize) * pixelSize * 4);
+        m_resampler->downscale(m_resampleBuffer.data(), m_pixelSize, m_pixelSize, m_pixelSize * 4,
+                               pixels.data(), pixelSize, pixelSize);
+        
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            uint32_t a = pixels[i + 3];
+            if (a == 0 || a == 255) {
+                continue;
+            }
+            for (int c = 0; c < 3; ++c) {
+                pixels[i + c] = static_cast<uint8_t>(std::min<uint32_t>(255, (pixels[i + c] * 255 + a / 2) / a));
+            }
+        }
+    }
+    return true;
 }
 
 bool EmojiManager::isEmoji(uint32_t codepoint) const {
-    return m_emojiGlyphs.find(codepoint) != m_emojiGlyphs.end();
+    return m_lookup.find(codepoint) >= 0;
 }
 
 } // namespace ImBored::UI
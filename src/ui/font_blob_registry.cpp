@@ -0,0 +1,147 @@
+#include "ui/font_blob_registry.hpp"
+#include <imgui.h>
+#include <imgui_internal.h>
+#include <iostream>
+#include <filesystem>
+#include <cstdio>
+
+// FreeType headers
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+namespace ImBored::UI {
+
+// Per-source ImGui loader for mapped fonts. Everything is forwarded to the
+// atlas's own loader (FreeType here); it only exists because AddFont
+// ImMemdup()s FontData unless the atlas owns it. Mapped sources are added
+// as owned, and FontSrcInit, which runs before anything could free
+// FontData, hands ownership back so the atlas never frees the mapping.
+static bool MappedFontSrcInit(ImFontAtlas* atlas, ImFontConfig* src) {
+    src->FontDataOwnedByAtlas = false;
+    const ImFontLoader* loader = atlas->FontLoader;
+    return loader->FontSrcInit == nullptr || loader->FontSrcInit(atlas, src);
+}
+
+static void MappedFontSrcDestroy(ImFontAtlas* atlas, ImFontConfig* src) {
+    if (atlas->FontLoader->FontSrcDestroy) {
+        atlas->FontLoader->FontSrcDestroy(atlas, src);
+    }
+}
+
+static bool MappedFontSrcContainsGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImWchar codepoint) {
+    return atlas->FontLoader->FontSrcContainsGlyph(atlas, src, codepoint);
+}
+
+static bool MappedFontBakedInit(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* loaderData) {
+    return atlas->FontLoader->FontBakedInit == nullptr || atlas->FontLoader->FontBakedInit(atlas, src, baked, loaderData);
+}
+
+static void MappedFontBakedDestroy(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* loaderData) {
+    if (atlas->FontLoader->FontBakedDestroy) {
+        atlas->FontLoader->FontBakedDestroy(atlas, src, baked, loaderData);
+    }
+}
+
+static bool MappedFontBakedLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* loaderData,
+                                     ImWchar codepoint, ImFontGlyph* glyph, float* advanceX) {
+    return atlas->FontLoader->FontBakedLoadGlyph(atlas, src, baked, loaderData, codepoint, glyph, advanceX);
+}
+
+// The wrapper for an atlas loader; per-baked data sizes must match it, so
+// the atlas has to keep that loader for as long as the fonts exist
+static const ImFontLoader* GetMappedFontLoader(const ImFontLoader* atlasLoader) {
+    static ImFontLoader loader;
+    loader.Name = "FontBlobRegistry";
+    loader.FontSrcInit = MappedFontSrcInit;
+    loader.FontSrcDestroy = MappedFontSrcDestroy;
+    loader.FontSrcContainsGlyph = atlasLoader->FontSrcContainsGlyph ? MappedFontSrcContainsGlyph : nullptr;
+    loader.FontBakedInit = MappedFontBakedInit;
+    loader.FontBakedDestroy = MappedFontBakedDestroy;
+    loader.FontBakedLoadGlyph = MappedFontBakedLoadGlyph;
+    loader.FontBakedSrcLoaderDataSize = atlasLoader->FontBakedSrcLoaderDataSize;
+    return &loader;
+}
+
+FontBlobRegistry& FontBlobRegistry::get() {
+    // Never destroyed before the ImGui atlas and faces that point into it
+    static FontBlobRegistry registry;
+    return registry;
+}
+
+const Core::MappedFile* FontBlobRegistry::acquire(const std::string& path) {
+    // Key on the canonical path so "./a.ttf" and "a.ttf" share one mapping
+    std::error_code ec;
+    std::string key = std::filesystem::weakly_canonical(path, ec).string();
+    if (ec || key.empty()) {
+        key = path;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    auto it = m_files.find(key);
+    if (it != m_files.end()) {
+        return it->second.get();
+    }
+    
+    auto file = std::make_unique<Core::MappedFile>();
+    if (!file->open(path)) {
+        std::cerr << "FontBlobRegistry: Failed to map " << path << "\n";
+        return nullptr;
+    }
+    
+    std::cout << "FontBlobRegistry: Mapped " << path << " (" << file->size() / 1024 << " KB)\n";
+    return m_files.emplace(key, std::move(file)).first->second.get();
+}
+
+void* FontBlobRegistry::newFace(void* ftLibrary, const Core::MappedFile& font, long faceIndex) {
+    FT_Face face;
+    if (FT_New_Memory_Face((FT_Library)ftLibrary, font.data(), static_cast<FT_Long>(font.size()),
+                           static_cast<FT_Long>(faceIndex), &face)) {
+        return nullptr;
+    }
+    return face;
+}
+
+ImFont* FontBlobRegistry::addImGuiFont(ImFontAtlas* atlas, const std::string& path, float sizePixels,
+                                       const ImFontConfig* config) {
+    const Core::MappedFile* font = acquire(path);
+    if (!font) {
+        return nullptr;
+    }
+    
+    ImFontConfig fontConfig = config ? *config : ImFontConfig();
+    
+    // AddFont would pick the atlas loader itself; the wrapper needs it now
+    if (atlas->Builder == nullptr) {
+        ImFontAtlasBuildInit(atlas);
+    }
+    if (fontConfig.FontLoader == nullptr) {
+        // Added as owned so AddFont skips its copy; the loader takes the
+        // ownership back before anything could free the mapping
+        fontConfig.FontLoader = GetMappedFontLoader(atlas->FontLoader);
+        fontConfig.FontDataOwnedByAtlas = true;
+    } else {
+        // A caller's own loader can't be wrapped, so ImGui copies the bytes
+        fontConfig.FontDataOwnedByAtlas = false;
+    }
+    if (fontConfig.Name[0] == '\0') {
+        std::string name = std::filesystem::path(path).filename().string();
+        std::snprintf(fontConfig.Name, sizeof(fontConfig.Name), "%s", name.c_str());
+    }
+    
+    // The mapping is read-only; ImGui never writes through FontData
+    return atlas->AddFontFromMemoryTTF(const_cast<uint8_t*>(font->data()), static_cast<int>(font->size()),
+                                       sizePixels, &fontConfig);
+}
+
+size_t FontBlobRegistry::getMappedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    size_t bytes = 0;
+    for (const auto& entry : m_files) {
+        bytes += entry.second->size();
+    }
+    return bytes;
+}
+
+} // namespace ImBored::UI
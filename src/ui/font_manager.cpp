@@ -1,4 +1,5 @@
 #include "../include/ui/font_manager.hpp"
+#include "../include/ui/font_blob_registry.hpp"
 #include <imgui.h>
 #include <imgui_freetype.h>
 #include <iostream>
@@ -15,10 +16,13 @@ void FontManager::loadQuicksandFont(const char* fontPath, float fontSize) {
     ImGuiIO& io = ImGui::GetIO();
     
     ImFontConfig config;
-    config.FontDataOwnedByAtlas = false;
     config.FontLoaderFlags = ImGuiFreeTypeLoaderFlags_LoadColor;
     
-    io.Fonts->AddFontFromFileTTF(fontPath, fontSize, &config);
+    // The atlas reads the shared mapping instead of loading its own copy
+    if (!FontBlobRegistry::get().addImGuiFont(io.Fonts, fontPath, fontSize, &config)) {
+        std::cerr << "FontManager: Failed to load " << fontPath << "\n";
+        return;
+    }
     
     io.Fonts->Build();
     m_fontsLoaded = true;
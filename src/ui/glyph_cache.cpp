@@ -0,0 +1,137 @@
+#include "ui/glyph_cache.hpp"
+#include "ui/font_blob_registry.hpp"
+#include <iostream>
+
+// FreeType headers
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+#include FT_CACHE_H
+
+namespace ImBored::UI {
+
+// Faces and sizes are few (one font, a handful of atlas sizes); the byte
+// budget is what bounds the cache
+static constexpr FT_UInt MAX_CACHED_FACES = 4;
+static constexpr FT_UInt MAX_CACHED_SIZES = 8;
+
+GlyphCache::GlyphCache(void* ftLibrary, size_t maxBytes)
+    : m_ftLibrary(ftLibrary)
+    , m_manager(nullptr)
+    , m_sbitCache(nullptr)
+    , m_imageCache(nullptr)
+    , m_maxBytes(maxBytes)
+{
+    // Faces are opened over the shared font mapping, never from disk
+    FTC_Face_Requester requester = [](FTC_FaceID faceId, FT_Library library, FT_Pointer, FT_Face* face) -> FT_Error {
+        const FaceSource* source = static_cast<const FaceSource*>(faceId);
+        *face = (FT_Face)FontBlobRegistry::newFace(library, *source->font, source->faceIndex);
+        return *face ? FT_Err_Ok : FT_Err_Cannot_Open_Resource;
+    };
+    
+    FTC_Manager manager;
+    if (FTC_Manager_New((FT_Library)ftLibrary, MAX_CACHED_FACES, MAX_CACHED_SIZES,
+                        static_cast<FT_ULong>(maxBytes), requester, nullptr, &manager)) {
+        std::cerr << "GlyphCache: Failed to create cache manager\n";
+        return;
+    }
+    m_manager = manager;
+    
+    FTC_SBitCache sbitCache;
+    if (FTC_SBitCache_New(manager, &sbitCache) == 0) {
+        m_sbitCache = sbitCache;
+    }
+    
+    FTC_ImageCache imageCache;
+    if (FTC_ImageCache_New(manager, &imageCache) == 0) {
+        m_imageCache = imageCache;
+    }
+}
+
+GlyphCache::~GlyphCache() {
+    // Also frees the caches and every face the manager opened
+    if (m_manager) {
+        FTC_Manager_Done((FTC_Manager)m_manager);
+    }
+}
+
+int GlyphCache::addFace(const Core::MappedFile& font, long faceIndex) {
+    auto source = std::make_unique<FaceSource>();
+    source->font = &font;
+    source->faceIndex = faceIndex;
+    m_faces.push_back(std::move(source));
+    return static_cast<int>(m_faces.size()) - 1;
+}
+
+bool GlyphCache::lookupGlyph(int face, int xPixels, int yPixels, uint32_t glyphIndex, int32_t loadFlags,
+                             CachedGlyphBitmap& bitmap, void** outline) {
+    if (!m_manager || face < 0 || face >= static_cast<int>(m_faces.size()) || xPixels <= 0 || yPixels <= 0) {
+        return false;
+    }
+    if (outline) {
+        *outline = nullptr;
+    }
+    
+    FTC_ScalerRec scaler;
+    scaler.face_id = m_faces[face].get();
+    scaler.width = static_cast<FT_UInt>(xPixels);
+    scaler.height = static_cast<FT_UInt>(yPixels);
+    scaler.pixel = 1;
+    scaler.x_res = 0;
+    scaler.y_res = 0;
+    
+    // Small coverage bitmaps live in the sbit cache, already rendered. Its
+    // 8-bit pitch can't hold color bitmaps, so those skip straight ahead.
+    if (m_sbitCache && outline && !(loadFlags & FT_LOAD_COLOR)) {
+        FTC_SBit sbit;
+        if (FTC_SBitCache_LookupScaler((FTC_SBitCache)m_sbitCache, &scaler, static_cast<FT_ULong>(loadFlags | FT_LOAD_RENDER),
+                                       glyphIndex, &sbit, nullptr) == 0 && sbit->buffer) {
+            bitmap.buffer = sbit->buffer;
+            bitmap.width = sbit->width;
+            bitmap.height = sbit->height;
+            bitmap.pitch = sbit->pitch;
+            bitmap.left = sbit->left;
+            bitmap.top = sbit->top;
+            bitmap.pixelMode = sbit->format;
+            return true;
+        }
+    }
+    
+    // Everything else is kept as an FT_Glyph: outlines unrendered so every
+    // use shares one copy, bitmaps as loaded
+    if (!m_imageCache) {
+        return false;
+    }
+    
+    FT_Glyph glyph;
+    if (FTC_ImageCache_LookupScaler((FTC_ImageCache)m_imageCache, &scaler, static_cast<FT_ULong>(loadFlags),
+                                    glyphIndex, &glyph, nullptr) != 0) {
+        return false;
+    }
+    
+    // The caller rasterizes the shared outline itself, no bitmap copy
+    if (glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+        if (!outline) {
+            return false;
+        }
+        *outline = &((FT_OutlineGlyph)glyph)->outline;
+        bitmap.buffer = nullptr;
+        return true;
+    }
+    
+    if (glyph->format != FT_GLYPH_FORMAT_BITMAP) {
+        return false;
+    }
+    
+    FT_BitmapGlyph bitmapGlyph = (FT_BitmapGlyph)glyph;
+    bitmap.buffer = bitmapGlyph->bitmap.buffer;
+    bitmap.width = static_cast<int>(bitmapGlyph->bitmap.width);
+    bitmap.height = static_cast<int>(bitmapGlyph->bitmap.rows);
+    bitmap.pitch = bitmapGlyph->bitmap.pitch;
+    bitmap.left = bitmapGlyph->left;
+    bitmap.top = bitmapGlyph->top;
+    bitmap.pixelMode = bitmapGlyph->bitmap.pixel_mode;
+    return true;
+}
+
+} // namespace ImBored::UI
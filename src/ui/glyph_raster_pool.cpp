@@ -0,0 +1,260 @@
+#include "ui/glyph_raster_pool.hpp"
+#include "ui/colrv1_renderer.hpp"
+#include "ui/svg_glyph_table.hpp"
+#include "ui/font_blob_registry.hpp"
+#include "ui/glyph_cache.hpp"
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+
+// FreeType headers
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+namespace ImBored::UI {
+
+// Below this many glyphs per worker, waking another worker (and on its first
+// batch, starting it and opening its faces) costs more than it saves
+static constexpr size_t MIN_JOBS_PER_WORKER = 16;
+
+// Jobs a worker takes from the queue at a time
+static constexpr size_t JOBS_PER_RUN = 8;
+
+GlyphRasterPool::GlyphRasterPool(const std::vector<GlyphRasterFont>& fonts, size_t glyphCacheBytes)
+    : m_fonts(fonts)
+    , m_glyphCacheBytes(glyphCacheBytes)
+    , m_stopping(false)
+{
+}
+
+GlyphRasterPool::~GlyphRasterPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workReady.notify_all();
+    
+    // Each worker frees its own FreeType state on the way out
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void GlyphRasterPool::releaseWorker(Worker& worker) {
+    for (WorkerFace& face : worker.faces) {
+        face.renderer.reset();
+        face.svgDocuments.reset();
+        if (face.ftFace) {
+            FT_Done_Face((FT_Face)face.ftFace);
+        }
+    }
+    worker.faces.clear();
+    worker.glyphCache.reset();
+    if (worker.ftLibrary) {
+        FT_Done_FreeType((FT_Library)worker.ftLibrary);
+        worker.ftLibrary = nullptr;
+    }
+}
+
+void GlyphRasterPool::configureFace(void* ftFace, int pixelSize) {
+    FT_Face face = (FT_Face)ftFace;
+    
+    // Scalable faces rasterize at the atlas size
+    if (FT_IS_SCALABLE(face)) {
+        FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(pixelSize));
+        return;
+    }
+    
+    // Bitmap-only faces can't be sized, only given a strike. Downscaling
+    // keeps detail that upscaling would have to invent, so prefer the
+    // smallest strike that is big enough, else the biggest there is.
+    if (face->num_fixed_sizes > 0) {
+        int best = -1;
+        int largest = 0;
+        for (int i = 0; i < face->num_fixed_sizes; i++) {
+            int height = face->available_sizes[i].height;
+            if (height >= pixelSize && (best < 0 || height < face->available_sizes[best].height)) {
+                best = i;
+            }
+            if (height > face->available_sizes[largest].height) {
+                largest = i;
+            }
+        }
+        FT_Select_Size(face, best >= 0 ? best : largest);
+    }
+}
+
+unsigned GlyphRasterPool::workerCountFor(size_t jobCount) {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t useful = jobCount / MIN_JOBS_PER_WORKER;
+    return static_cast<unsigned>(std::clamp<size_t>(useful, 1, hardware));
+}
+
+bool GlyphRasterPool::prepareWorker(Worker& worker, float fontSize, int pixelSize) {
+    if (!worker.ftLibrary) {
+        FT_Library library;
+        if (FT_Init_FreeType(&library)) {
+            return false;
+        }
+        worker.ftLibrary = library;
+    }
+    
+    // FTC is not thread-safe either; every worker caches its own glyphs,
+    // kept across batches so size toggles reuse them
+    if (m_glyphCacheBytes > 0 && !worker.glyphCache) {
+        size_t share = m_glyphCacheBytes / std::max(1u, std::thread::hardware_concurrency());
+        worker.glyphCache = std::make_unique<GlyphCache>(worker.ftLibrary, share);
+    }
+    
+    bool resized = worker.fontSize != fontSize || worker.pixelSize != pixelSize;
+    worker.faces.resize(m_fonts.size()); // New entries are value-initialized: no face yet
+    for (size_t i = 0; i < m_fonts.size(); ++i) {
+        WorkerFace& face = worker.faces[i];
+        const GlyphRasterFont& font = m_fonts[i];
+        
+        if (!face.ftFace) {
+            // Each worker gets its own face over the shared, read-only font bytes
+            face.ftFace = FontBlobRegistry::newFace(worker.ftLibrary, *font.file);
+            if (!face.ftFace) {
+                return false;
+            }
+            configureFace(face.ftFace, pixelSize);
+            face.glyphCacheFace = worker.glyphCache ? worker.glyphCache->addFace(*font.file) : -1;
+        } else if (resized) {
+            configureFace(face.ftFace, pixelSize);
+        }
+        
+        // LunaSVG documents are not thread-safe, so every worker parses its own
+        if (font.svgTable && !face.svgDocuments) {
+            face.svgDocuments = std::make_unique<SvgDocumentCache>(font.svgTable);
+        }
+        
+        if (!face.renderer || face.renderer->getWidth() != pixelSize) {
+            face.renderer = std::make_unique<COLRv1Renderer>(pixelSize, pixelSize);
+            face.renderer->setSvgDocuments(face.svgDocuments.get());
+            face.renderer->setGlyphCache(worker.glyphCache.get(), face.glyphCacheFace);
+        }
+    }
+    worker.fontSize = fontSize;
+    worker.pixelSize = pixelSize;
+    
+    return true;
+}
+
+void GlyphRasterPool::workerMain() {
+    Worker worker;
+    worker.ftLibrary = nullptr;
+    worker.fontSize = 0.0f;
+    worker.pixelSize = 0;
+    
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_workReady.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            break;
+        }
+        Run run = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        
+        // Faces are opened or resized here, on the thread that uses them,
+        // and only when the batch's size differs from the last one
+        if (prepareWorker(worker, run.task->fontSize, run.task->batch->pixelSize)) {
+            renderRun(worker, run);
+        } else {
+            std::cerr << "GlyphRasterPool: Worker could not open its fonts, skipping "
+                      << run.end - run.begin << " glyphs\n";
+        }
+        
+        lock.lock();
+        if (--run.task->runsLeft == 0) {
+            m_batchDone.notify_all();
+        }
+    }
+    lock.unlock();
+    
+    releaseWorker(worker);
+}
+
+void GlyphRasterPool::renderRun(Worker& worker, const Run& run) {
+    const std::vector<GlyphRasterJob>& jobs = *run.task->jobs;
+    const uint32_t* order = run.task->order;
+    GlyphRasterBatch& batch = *run.task->batch;
+    int pixelSize = batch.pixelSize;
+    
+    AtlasView view;
+    view.pixels = batch.pixels.data();
+    view.width = pixelSize;
+    view.height = static_cast<int>(jobs.size()) * pixelSize;
+    view.stride = static_cast<size_t>(pixelSize) * 4;
+    
+    // One renderGlyphs call per font in the run, straight into the batch;
+    // where a glyph ends up only depends on its job index
+    GlyphRequest requests[JOBS_PER_RUN];
+    size_t begin = run.begin;
+    while (begin < run.end) {
+        uint32_t font = jobs[order[begin]].font;
+        size_t count = 0;
+        for (size_t i = begin; i < run.end && jobs[order[i]].font == font; ++i) {
+            requests[count++] = {jobs[order[i]].glyphIndex, 0, static_cast<int>(order[i]) * pixelSize, false};
+        }
+        
+        WorkerFace& face = worker.faces[font];
+        face.renderer->renderGlyphs(face.ftFace, std::span<GlyphRequest>(requests, count), view);
+        for (size_t i = 0; i < count; ++i) {
+            batch.rendered[order[begin++]] = requests[i].rendered ? 1 : 0;
+        }
+    }
+}
+
+void GlyphRasterPool::rasterize(const std::vector<GlyphRasterJob>& jobs, float fontSize, int pixelSize,
+                                GlyphRasterBatch& batch) {
+    // The renderers clear each cell before drawing, so no need to zero
+    batch.pixelSize = pixelSize;
+    batch.pixels.resize(jobs.size() * pixelSize * pixelSize * 4);
+    batch.rendered.assign(jobs.size(), 0);
+    if (jobs.empty()) {
+        return;
+    }
+    
+    // Threads are only started when a batch is big enough to use them
+    unsigned workerCount = workerCountFor(jobs.size());
+    while (m_threads.size() < workerCount) {
+        m_threads.emplace_back(&GlyphRasterPool::workerMain, this);
+    }
+    
+    // Jobs are handed out by font, then glyph, so a run mostly stays in one
+    // face and walks its tables forward
+    std::vector<uint32_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (jobs[a].font != jobs[b].font) {
+            return jobs[a].font < jobs[b].font;
+        }
+        return jobs[a].glyphIndex < jobs[b].glyphIndex;
+    });
+    
+    BatchTask task;
+    task.jobs = &jobs;
+    task.order = order.data();
+    task.batch = &batch;
+    task.fontSize = fontSize;
+    task.runsLeft = 0;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t begin = 0; begin < jobs.size(); begin += JOBS_PER_RUN) {
+            m_queue.push_back({&task, begin, std::min(jobs.size(), begin + JOBS_PER_RUN)});
+            task.runsLeft++;
+        }
+    }
+    m_workReady.notify_all();
+    
+    // Taking the mutex after the last run also makes the workers' pixel
+    // writes visible here
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_batchDone.wait(lock, [&] { return task.runsLeft == 0; });
+}
+
+} // namespace ImBored::UI
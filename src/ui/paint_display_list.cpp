@@ -0,0 +1,420 @@
+#include "ui/paint_display_list.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// FreeType headers
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_COLOR_H
+
+namespace ImBored::UI {
+
+// PaintColrGlyph can recurse; graphs deeper than this are treated as broken
+static constexpr int MAX_PAINT_DEPTH = 64;
+static constexpr float PI = 3.14159265358979f;
+
+static float FixedToFloat(FT_Fixed value) {
+    return static_cast<float>(value) / 65536.0f;
+}
+
+static float F2Dot14ToFloat(FT_F2Dot14 value) {
+    return static_cast<float>(value) / 16384.0f;
+}
+
+// FreeType 2.13 widened color stop offsets from F2Dot14 to 16.16
+static float StopOffsetToFloat(const FT_ColorStop& stop) {
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 13)
+    return FixedToFloat(stop.stop_offset);
+#else
+    return F2Dot14ToFloat(stop.stop_offset);
+#endif
+}
+
+namespace {
+
+// Walks one glyph's paint graph and appends it to a display list
+class PaintCompiler {
+public:
+    PaintCompiler(FT_Face face, PaintDisplayList& list)
+        : m_face(face)
+        , m_list(list)
+        , m_palette(nullptr)
+        , m_paletteSize(0)
+    {
+        FT_Palette_Data paletteData;
+        FT_Color* palette = nullptr;
+        if (FT_Palette_Data_Get(face, &paletteData) == 0 && FT_Palette_Select(face, 0, &palette) == 0) {
+            m_palette = palette;
+            m_paletteSize = paletteData.num_palette_entries;
+        }
+    }
+    
+    // Append the ops for a paint; returns false if it draws nothing
+    bool compile(const FT_OpaquePaint& opaquePaint, int depth);
+    
+private:
+    bool compileFill(const FT_COLR_Paint& paint);
+    bool compileTransform(const PaintDisplayList::Transform& transform, const FT_OpaquePaint& child, int depth);
+    
+    // Index of the glyph's outline in the list, copying it on first use.
+    // -1 if the glyph has no outline.
+    int compileOutline(FT_UInt glyphIndex);
+    
+    // Premultiplied RGBA for a palette entry scaled by alpha
+    void resolveColor(uint16_t paletteIndex, float alpha, float rgba[4]) const;
+    
+    FT_Face m_face;
+    PaintDisplayList& m_list;
+    const FT_Color* m_palette;
+    uint16_t m_paletteSize;
+    std::unordered_map<FT_UInt, int> m_outlineIndex;
+};
+
+bool PaintCompiler::compile(const FT_OpaquePaint& opaquePaint, int depth) {
+    if (depth > MAX_PAINT_DEPTH) {
+        return false;
+    }
+    
+    FT_COLR_Paint paint;
+    if (!FT_Get_Paint(m_face, opaquePaint, &paint)) {
+        return false;
+    }
+    
+    switch (paint.format) {
+        case FT_COLR_PAINTFORMAT_COLR_LAYERS: {
+            FT_OpaquePaint layerPaint;
+            layerPaint.p = nullptr;
+            layerPaint.insert_root_transform = 0;
+            bool drawn = false;
+            while (FT_Get_Paint_Layers(m_face, &paint.u.colr_layers.layer_iterator, &layerPaint)) {
+                drawn |= compile(layerPaint, depth + 1);
+            }
+            return drawn;
+        }
+        
+        case FT_COLR_PAINTFORMAT_SOLID:
+        case FT_COLR_PAINTFORMAT_LINEAR_GRADIENT:
+        case FT_COLR_PAINTFORMAT_RADIAL_GRADIENT:
+        case FT_COLR_PAINTFORMAT_SWEEP_GRADIENT:
+            return compileFill(paint);
+        
+        case FT_COLR_PAINTFORMAT_GLYPH: {
+            int outline = compileOutline(paint.u.glyph.glyphID);
+            if (outline < 0) {
+                return false;
+            }
+            size_t start = m_list.ops.size();
+            m_list.ops.push_back({PaintDisplayList::OP_CLIP, 0, static_cast<uint32_t>(outline), 0});
+            if (!compile(paint.u.glyph.paint, depth + 1)) {
+                m_list.ops.resize(start);
+                return false;
+            }
+            m_list.ops[start].end = static_cast<uint32_t>(m_list.ops.size());
+            return true;
+        }
+        
+        case FT_COLR_PAINTFORMAT_COLR_GLYPH: {
+            // Inlined, so replaying never goes back to the COLR table
+            FT_OpaquePaint glyphPaint;
+            glyphPaint.p = nullptr;
+            glyphPaint.insert_root_transform = 0;
+            if (!FT_Get_Color_Glyph_Paint(m_face, paint.u.colr_glyph.glyphID, FT_COLOR_NO_ROOT_TRANSFORM, &glyphPaint)) {
+                return false;
+            }
+            return compile(glyphPaint, depth + 1);
+        }
+        
+        case FT_COLR_PAINTFORMAT_TRANSFORM: {
+            const FT_Affine23& affine = paint.u.transform.affine;
+            return compileTransform({FixedToFloat(affine.xx), FixedToFloat(affine.xy), FixedToFloat(affine.dx),
+                                     FixedToFloat(affine.yx), FixedToFloat(affine.yy), FixedToFloat(affine.dy)},
+                                    paint.u.transform.paint, depth);
+        }
+        
+        case FT_COLR_PAINTFORMAT_TRANSLATE:
+            return compileTransform({1.0f, 0.0f, FixedToFloat(paint.u.translate.dx),
+                                     0.0f, 1.0f, FixedToFloat(paint.u.translate.dy)},
+                                    paint.u.translate.paint, depth);
+        
+        case FT_COLR_PAINTFORMAT_SCALE: {
+            float sx = FixedToFloat(paint.u.scale.scale_x);
+            float sy = FixedToFloat(paint.u.scale.scale_y);
+            float cx = FixedToFloat(paint.u.scale.center_x);
+            float cy = FixedToFloat(paint.u.scale.center_y);
+            return compileTransform({sx, 0.0f, cx - sx * cx,
+                                     0.0f, sy, cy - sy * cy},
+                                    paint.u.scale.paint, depth);
+        }
+        
+        case FT_COLR_PAINTFORMAT_ROTATE: {
+            // Counter-clockwise, in units of 180 degrees
+            float angle = FixedToFloat(paint.u.rotate.angle) * PI;
+            float c = std::cos(angle);
+            float s = std::sin(angle);
+            float cx = FixedToFloat(paint.u.rotate.center_x);
+            float cy = FixedToFloat(paint.u.rotate.center_y);
+            return compileTransform({c, -s, cx - c * cx + s * cy,
+                                     s, c, cy - s * cx - c * cy},
+                                    paint.u.rotate.paint, depth);
+        }
+        
+        case FT_COLR_PAINTFORMAT_SKEW: {
+            // Counter-clockwise angles, so the x skew leans the y axis left
+            float kx = -std::tan(FixedToFloat(paint.u.skew.x_skew_angle) * PI);
+            float ky = std::tan(FixedToFloat(paint.u.skew.y_skew_angle) * PI);
+            float cx = FixedToFloat(paint.u.skew.center_x);
+            float cy = FixedToFloat(paint.u.skew.center_y);
+            return compileTransform({1.0f, kx, -kx * cy,
+                                     ky, 1.0f, -ky * cx},
+                                    paint.u.skew.paint, depth);
+        }
+        
+        case FT_COLR_PAINTFORMAT_COMPOSITE: {
+            // Kept even when a side is empty: modes like SRC_OUT still draw
+            size_t start = m_list.ops.size();
+            m_list.ops.push_back({PaintDisplayList::OP_COMPOSITE,
+                                  static_cast<uint8_t>(paint.u.composite.composite_mode), 0, 0});
+            compile(paint.u.composite.backdrop_paint, depth + 1);
+            m_list.ops[start].data = static_cast<uint32_t>(m_list.ops.size());
+            compile(paint.u.composite.source_paint, depth + 1);
+            m_list.ops[start].end = static_cast<uint32_t>(m_list.ops.size());
+            return true;
+        }
+        
+        default:
+            return false;
+    }
+}
+
+bool PaintCompiler::compileTransform(const PaintDisplayList::Transform& transform, const FT_OpaquePaint& child,
+                                     int depth) {
+    size_t start = m_list.ops.size();
+    m_list.ops.push_back({PaintDisplayList::OP_TRANSFORM, 0, static_cast<uint32_t>(m_list.transforms.size()), 0});
+    m_list.transforms.push_back(transform);
+    if (!compile(child, depth + 1)) {
+        m_list.ops.resize(start);
+        m_list.transforms.pop_back();
+        return false;
+    }
+    m_list.ops[start].end = static_cast<uint32_t>(m_list.ops.size());
+    return true;
+}
+
+bool PaintCompiler::compileFill(const FT_COLR_Paint& paint) {
+    PaintDisplayList::Fill fill = {};
+    fill.format = static_cast<uint8_t>(paint.format);
+    fill.extend = FT_COLR_PAINT_EXTEND_PAD;
+    
+    const FT_ColorLine* colorLine = nullptr;
+    switch (paint.format) {
+        case FT_COLR_PAINTFORMAT_SOLID:
+            resolveColor(paint.u.solid.color.palette_index, F2Dot14ToFloat(paint.u.solid.color.alpha), fill.color);
+            if (fill.color[3] <= 0.0f) {
+                return false;
+            }
+            break;
+        
+        case FT_COLR_PAINTFORMAT_LINEAR_GRADIENT: {
+            const FT_PaintLinearGradient& linear = paint.u.linear_gradient;
+            const FT_Vector* points[3] = {&linear.p0, &linear.p1, &linear.p2};
+            for (int i = 0; i < 3; ++i) {
+                fill.geometry[i * 2] = FixedToFloat(points[i]->x);
+                fill.geometry[i * 2 + 1] = FixedToFloat(points[i]->y);
+            }
+            colorLine = &linear.colorline;
+            break;
+        }
+        
+        case FT_COLR_PAINTFORMAT_RADIAL_GRADIENT: {
+            const FT_PaintRadialGradient& radial = paint.u.radial_gradient;
+            fill.geometry[0] = FixedToFloat(radial.c0.x);
+            fill.geometry[1] = FixedToFloat(radial.c0.y);
+            fill.geometry[2] = FixedToFloat(radial.r0);
+            fill.geometry[3] = FixedToFloat(radial.c1.x);
+            fill.geometry[4] = FixedToFloat(radial.c1.y);
+            fill.geometry[5] = FixedToFloat(radial.r1);
+            colorLine = &radial.colorline;
+            break;
+        }
+        
+        default: { // FT_COLR_PAINTFORMAT_SWEEP_GRADIENT
+            const FT_PaintSweepGradient& sweep = paint.u.sweep_gradient;
+            fill.geometry[0] = FixedToFloat(sweep.center.x);
+            fill.geometry[1] = FixedToFloat(sweep.center.y);
+            fill.geometry[2] = FixedToFloat(sweep.start_angle);
+            fill.geometry[3] = FixedToFloat(sweep.end_angle);
+            colorLine = &sweep.colorline;
+            break;
+        }
+    }
+    
+    if (colorLine) {
+        // Reading stops advances the iterator, so work on a copy
+        FT_ColorStopIterator iterator = colorLine->color_stop_iterator;
+        fill.extend = static_cast<uint8_t>(colorLine->extend);
+        fill.firstStop = static_cast<uint32_t>(m_list.stops.size() / 5);
+        
+        FT_ColorStop stop;
+        while (FT_Get_Colorline_Stops(m_face, &stop, &iterator)) {
+            float rgba[4];
+            resolveColor(stop.color.palette_index, F2Dot14ToFloat(stop.color.alpha), rgba);
+            m_list.stops.push_back(StopOffsetToFloat(stop));
+            m_list.stops.insert(m_list.stops.end(), rgba, rgba + 4);
+        }
+        
+        fill.stopCount = static_cast<uint32_t>(m_list.stops.size() / 5) - fill.firstStop;
+        if (fill.stopCount == 0) {
+            return false;
+        }
+        
+        // Stops may come in any order; there are only a few, so insertion
+        // sort (stable, so equal offsets keep their hard edge)
+        auto first = m_list.stops.begin() + fill.firstStop * 5;
+        for (size_t i = 1; i < fill.stopCount; ++i) {
+            for (size_t j = i; j > 0 && first[j * 5] < first[(j - 1) * 5]; --j) {
+                std::swap_ranges(first + j * 5, first + j * 5 + 5, first + (j - 1) * 5);
+            }
+        }
+    }
+    
+    m_list.ops.push_back({PaintDisplayList::OP_FILL, 0, static_cast<uint32_t>(m_list.fills.size()), 0});
+    m_list.ops.back().end = static_cast<uint32_t>(m_list.ops.size());
+    m_list.fills.push_back(fill);
+    return true;
+}
+
+int PaintCompiler::compileOutline(FT_UInt glyphIndex) {
+    auto it = m_outlineIndex.find(glyphIndex);
+    if (it != m_outlineIndex.end()) {
+        return it->second;
+    }
+    
+    // Unscaled, so the copy is the same at every size
+    int index = -1;
+    if (FT_Load_Glyph(m_face, glyphIndex, FT_LOAD_NO_SCALE) == 0 &&
+        m_face->glyph->format == FT_GLYPH_FORMAT_OUTLINE && m_face->glyph->outline.n_points > 0) {
+        const FT_Outline& source = m_face->glyph->outline;
+        PaintDisplayList::Outline outline;
+        outline.firstPoint = static_cast<uint32_t>(m_list.points.size() / 2);
+        outline.pointCount = static_cast<uint32_t>(source.n_points);
+        outline.firstContour = static_cast<uint32_t>(m_list.contours.size());
+        outline.contourCount = static_cast<uint32_t>(source.n_contours);
+        outline.flags = source.flags;
+        
+        for (int i = 0; i < source.n_points; ++i) {
+            m_list.points.push_back(static_cast<float>(source.points[i].x));
+            m_list.points.push_back(static_cast<float>(source.points[i].y));
+            m_list.tags.push_back(static_cast<uint8_t>(source.tags[i]));
+        }
+        for (int i = 0; i < source.n_contours; ++i) {
+            m_list.contours.push_back(static_cast<uint16_t>(source.contours[i]));
+        }
+        
+        index = static_cast<int>(m_list.outlines.size());
+        m_list.outlines.push_back(outline);
+    }
+    
+    m_outlineIndex[glyphIndex] = index;
+    return index;
+}
+
+void PaintCompiler::resolveColor(uint16_t paletteIndex, float alpha, float rgba[4]) const {
+    // 0xFFFF is the text color; emoji are drawn on their own, so use black
+    // like the COLR v0 path
+    float r = 0.0f, g = 0.0f, b = 0.0f, a = 1.0f;
+    if (paletteIndex != 0xFFFF && m_palette && paletteIndex < m_paletteSize) {
+        const FT_Color& color = m_palette[paletteIndex];
+        r = color.red / 255.0f;
+        g = color.green / 255.0f;
+        b = color.blue / 255.0f;
+        a = color.alpha / 255.0f;
+    }
+    
+    a *= std::clamp(alpha, 0.0f, 1.0f);
+    rgba[0] = r * a;
+    rgba[1] = g * a;
+    rgba[2] = b * a;
+    rgba[3] = a;
+}
+
+} // namespace
+
+size_t PaintDisplayList::getBytes() const {
+    return sizeof(*this)
+        + ops.capacity() * sizeof(Op)
+        + transforms.capacity() * sizeof(Transform)
+        + fills.capacity() * sizeof(Fill)
+        + stops.capacity() * sizeof(float)
+        + outlines.capacity() * sizeof(Outline)
+        + points.capacity() * sizeof(float)
+        + tags.capacity()
+        + contours.capacity() * sizeof(uint16_t);
+}
+
+PaintDisplayListCache& PaintDisplayListCache::get() {
+    static PaintDisplayListCache cache;
+    return cache;
+}
+
+PaintDisplayListCache::PaintDisplayListCache()
+    : m_bytes(0)
+{
+}
+
+size_t PaintDisplayListCache::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<const void*>()(key.font);
+    hash ^= std::hash<long>()(key.faceIndex) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<uint32_t>()(key.glyphIndex) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+std::shared_ptr<const PaintDisplayList> PaintDisplayListCache::acquire(void* ftFace, uint32_t glyphIndex) {
+    FT_Face face = (FT_Face)ftFace;
+    
+    // Memory faces read straight from their bytes, which identify the font
+    // across every thread's face
+    const void* font = face->stream ? face->stream->base : nullptr;
+    Key key = {font, face->face_index, glyphIndex};
+    if (font) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_lists.find(key);
+        if (it != m_lists.end()) {
+            return it->second;
+        }
+    }
+    
+    // Compiled outside the lock so workers on other glyphs don't wait; a
+    // race on the same glyph compiles it twice and keeps the first
+    std::shared_ptr<PaintDisplayList> list;
+    FT_OpaquePaint root;
+    root.p = nullptr;
+    root.insert_root_transform = 0;
+    if (FT_Get_Color_Glyph_Paint(face, glyphIndex, FT_COLOR_NO_ROOT_TRANSFORM, &root)) {
+        list = std::make_shared<PaintDisplayList>();
+        PaintCompiler compiler(face, *list);
+        compiler.compile(root, 0);
+        list->ops.shrink_to_fit();
+        list->points.shrink_to_fit();
+        list->tags.shrink_to_fit();
+        list->contours.shrink_to_fit();
+    }
+    
+    if (!font) {
+        return list;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto inserted = m_lists.emplace(key, list);
+    if (inserted.second && list) {
+        m_bytes += list->getBytes();
+    }
+    return inserted.first->second;
+}
+
+size_t PaintDisplayListCache::getBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+} // namespace ImBored::UI
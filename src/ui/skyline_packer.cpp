@@ -0,0 +1,134 @@
+#include "ui/skyline_packer.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace ImBored::UI {
+
+SkylinePacker::SkylinePacker()
+    : m_width(0)
+    , m_height(0)
+    , m_usedArea(0)
+{
+}
+
+void SkylinePacker::reset(int width, int height) {
+    m_width = width;
+    m_height = height;
+    m_usedArea = 0;
+    m_nodes.clear();
+    m_nodes.push_back({0, 0, width});
+}
+
+void SkylinePacker::grow(int width, int height) {
+    // Extra columns start out empty at the bottom of the skyline
+    if (width > m_width) {
+        m_nodes.push_back({m_width, 0, width - m_width});
+        m_width = width;
+        mergeNodes();
+    }
+    m_height = std::max(m_height, height);
+}
+
+void SkylinePacker::restore(int width, int height, const std::vector<SkylineNode>& nodes, int64_t usedArea) {
+    m_width = width;
+    m_height = height;
+    m_usedArea = usedArea;
+    m_nodes = nodes;
+}
+
+float SkylinePacker::getOccupancy() const {
+    int64_t total = static_cast<int64_t>(m_width) * m_height;
+    return total > 0 ? static_cast<float>(m_usedArea) / static_cast<float>(total) : 0.0f;
+}
+
+bool SkylinePacker::fitAt(size_t index, int width, int height, int& y) const {
+    int x = m_nodes[index].x;
+    if (x + width > m_width) {
+        return false;
+    }
+    
+    // The rectangle rests on the highest node it spans
+    y = 0;
+    int remaining = width;
+    for (size_t i = index; remaining > 0; ++i) {
+        y = std::max(y, static_cast<int>(m_nodes[i].y));
+        if (y + height > m_height) {
+            return false;
+        }
+        remaining -= m_nodes[i].width;
+    }
+    
+    return true;
+}
+
+bool SkylinePacker::pack(int width, int height, int& x, int& y) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    
+    // Bottom-left heuristic: lowest top edge, then narrowest node
+    size_t bestIndex = m_nodes.size();
+    int bestTop = std::numeric_limits<int>::max();
+    int bestWidth = std::numeric_limits<int>::max();
+    int bestY = 0;
+    
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        int fitY;
+        if (!fitAt(i, width, height, fitY)) {
+            continue;
+        }
+        
+        int top = fitY + height;
+        if (top < bestTop || (top == bestTop && m_nodes[i].width < bestWidth)) {
+            bestIndex = i;
+            bestTop = top;
+            bestWidth = m_nodes[i].width;
+            bestY = fitY;
+        }
+    }
+    
+    if (bestIndex == m_nodes.size()) {
+        return false;
+    }
+    
+    x = m_nodes[bestIndex].x;
+    y = bestY;
+    
+    // Insert the new segment and trim the ones it now covers
+    SkylineNode node = {x, bestY + height, width};
+    m_nodes.insert(m_nodes.begin() + bestIndex, node);
+    
+    for (size_t i = bestIndex + 1; i < m_nodes.size(); ) {
+        SkylineNode& prev = m_nodes[i - 1];
+        SkylineNode& curr = m_nodes[i];
+        int prevRight = prev.x + prev.width;
+        if (curr.x >= prevRight) {
+            break;
+        }
+        
+        int shrink = prevRight - curr.x;
+        curr.x += shrink;
+        curr.width -= shrink;
+        if (curr.width > 0) {
+            break;
+        }
+        m_nodes.erase(m_nodes.begin() + i);
+    }
+    
+    mergeNodes();
+    m_usedArea += static_cast<int64_t>(width) * height;
+    return true;
+}
+
+void SkylinePacker::mergeNodes() {
+    for (size_t i = 0; i + 1 < m_nodes.size(); ) {
+        if (m_nodes[i].y == m_nodes[i + 1].y) {
+            m_nodes[i].width += m_nodes[i + 1].width;
+            m_nodes.erase(m_nodes.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+}
+
+} // namespace ImBored::UI
@@ -3,6 +3,9 @@
 #include "imgui.h"
 #include <string>
 #include <cstring>
+#include <vector>
+#include <algorithm>
+#include <climits>
 
 namespace ImBored::UI {
 
@@ -12,115 +15,168 @@ void SmartTextInit(EmojiManager* emojiManager) {
     g_emojiManager = emojiManager;
 }
 
-// Helper to decode UTF-8 codepoint
-static uint32_t decodeUTF8(const char*& str) {
+// Emoji quad waiting to be drawn with the rest of its atlas page
+struct EmojiQuad {
+    int page;
+    ImVec2 p0, p1;
+    ImVec2 uv0, uv1;
+};
+
+// Reused between calls so collecting quads doesn't allocate per frame
+static std::vector<EmojiQuad> g_emojiQuads;
+
+static void queueEmojiQuad(EmojiManager* emojiManager, const EmojiGlyph* emoji, const ImVec2& emojiPos) {
+    // Keeps the glyph out of LRU eviction while it is on screen
+    emojiManager->markUsed(emoji);
+    
+    // Glyphs still queued for rasterization only reserve their space;
+    // the atlas holds the trimmed ink, placed inside the glyph box
+    if (!emoji->resident || emoji->x1 <= emoji->x0) {
+        return;
+    }
+    
+    // Non-1 only while a font size change is rebuilding the atlas
+    float scale = emojiManager->getDrawScale();
+    g_emojiQuads.push_back({
+        emoji->page,
+        ImVec2(emojiPos.x + emoji->x0 * scale, emojiPos.y + emoji->y0 * scale),
+        ImVec2(emojiPos.x + emoji->x1 * scale, emojiPos.y + emoji->y1 * scale),
+        ImVec2(emoji->u0, emoji->v0),
+        ImVec2(emoji->u1, emoji->v1)
+    });
+}
+
+// Each texture change starts a new draw command, so emit quads grouped by
+// page. A line touches few pages, so one pass per page keeps the quads in
+// order without a sort and its temporary buffer.
+static void flushEmojiQuads(ImDrawList* drawList, EmojiManager* emojiManager) {
+    int page = INT_MAX;
+    for (const EmojiQuad& quad : g_emojiQuads) {
+        page = std::min(page, quad.page);
+    }
+    
+    while (page != INT_MAX) {
+        int nextPage = INT_MAX;
+        for (const EmojiQuad& quad : g_emojiQuads) {
+            if (quad.page == page) {
+                drawList->AddImage(emojiManager->getTextureID(quad.page), quad.p0, quad.p1, quad.uv0, quad.uv1);
+            } else if (quad.page > page) {
+                nextPage = std::min(nextPage, quad.page);
+            }
+        }
+        page = nextPage;
+    }
+    g_emojiQuads.clear();
+}
+
+// Helper to decode UTF-8 codepoint. Sequences cut short by `end` decode
+// as 0 and stop there.
+static uint32_t decodeUTF8(const char*& str, const char* end) {
     uint32_t codepoint = 0;
     unsigned char c = *str++;
+    int continuation = 0;
     
     if (c < 0x80) {
-        codepoint = c;
+        return c;
     } else if ((c & 0xE0) == 0xC0) {
-        codepoint = (c & 0x1F) << 6;
-        codepoint |= (*str++ & 0x3F);
+        codepoint = c & 0x1F;
+        continuation = 1;
     } else if ((c & 0xF0) == 0xE0) {
-        codepoint = (c & 0x0F) << 12;
-        codepoint |= (*str++ & 0x3F) << 6;
-        codepoint |= (*str++ & 0x3F);
+        codepoint = c & 0x0F;
+        continuation = 2;
     } else if ((c & 0xF8) == 0xF0) {
-        codepoint = (c & 0x07) << 18;
-        codepoint |= (*str++ & 0x3F) << 12;
-        codepoint |= (*str++ & 0x3F) << 6;
-        codepoint |= (*str++ & 0x3F);
+        codepoint = c & 0x07;
+        continuation = 3;
+    }
+    
+    if (end - str < continuation) {
+        str = end;
+        return 0;
+    }
+    for (int i = 0; i < continuation; ++i) {
+        codepoint = (codepoint << 6) | (*str++ & 0x3F);
     }
     
     return codepoint;
 }
 
-void SmartText(const char* text) {
-    if (!g_emojiManager || !text) {
-        ImGui::TextUnformatted(text);
-        return;
-    }
-    
-    ImDrawList* drawList = ImGui::GetWindowDrawList();
-    ImVec2 pos = ImGui::GetCursorScreenPos();
-    ImU32 color = ImGui::GetColorU32(ImGuiCol_Text);
-    
-    const char* textPtr = text;
-    std::string buffer;
-    float lineHeight = ImGui::GetTextLineHeight();
+// Draw [text, textEnd) from pos. Text between emoji goes to AddText as a
+// range of the caller's bytes, never copied. Emoji shorter than
+// lineHeight are centered on the line (0 to align them to the top).
+// Returns where the text ends if measureEnd, else where the last run starts.
+static float drawSmartText(ImDrawList* drawList, const char* text, const char* textEnd, const ImVec2& pos,
+                           ImU32 color, EmojiManager* emojiManager, float lineHeight, bool measureEnd) {
+    float drawScale = emojiManager->getDrawScale();
     float cursorX = pos.x;
+    const char* runStart = text;
+    const char* textPtr = text;
     
-    while (*textPtr) {
-        uint32_t codepoint = decodeUTF8(textPtr);
+    while (textPtr < textEnd) {
+        const char* glyphStart = textPtr;
+        uint32_t codepoint = decodeUTF8(textPtr, textEnd);
         
-        // Check if it's an emoji
-        const EmojiGlyph* emoji = g_emojiManager->getEmoji(codepoint);
+        // Regular characters just extend the current run
+        const EmojiGlyph* emoji = emojiManager->getEmoji(codepoint);
+        if (!emoji) {
+            continue;
+        }
         
-        if (emoji) {
-            // Render any accumulated text first
-            if (!buffer.empty()) {
-                ImVec2 textPos(cursorX, pos.y);
-                drawList->AddText(textPos, color, buffer.c_str());
-                cursorX += ImGui::CalcTextSize(buffer.c_str()).x;
-                buffer.clear();
-            }
-            
-            // Render emoji as image
-            ImVec2 emojiPos(cursorX, pos.y);
-            ImVec2 emojiSize(emoji->width, emoji->height);
-            
-            // Center vertically if smaller than line height
-            if (emoji->height < lineHeight) {
-                emojiPos.y += (lineHeight - emoji->height) * 0.5f;
-            }
-            
-            ImVec2 uv0(emoji->u0, emoji->v0);
-            ImVec2 uv1(emoji->u1, emoji->v1);
-            
-            drawList->AddImage(
-                g_emojiManager->getTextureID(),
-                emojiPos,
-                ImVec2(emojiPos.x + emojiSize.x, emojiPos.y + emojiSize.y),
-                uv0,
-                uv1
-            );
-            
-            cursorX += emoji->advance;
-        } else {
-            // Regular character - add to buffer
-            // Re-encode codepoint to UTF-8
-            if (codepoint < 0x80) {
-                buffer += static_cast<char>(codepoint);
-            } else if (codepoint < 0x800) {
-                buffer += static_cast<char>(0xC0 | (codepoint >> 6));
-                buffer += static_cast<char>(0x80 | (codepoint & 0x3F));
-            } else if (codepoint < 0x10000) {
-                buffer += static_cast<char>(0xE0 | (codepoint >> 12));
-                buffer += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
-                buffer += static_cast<char>(0x80 | (codepoint & 0x3F));
-            } else {
-                buffer += static_cast<char>(0xF0 | (codepoint >> 18));
-                buffer += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
-                buffer += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
-                buffer += static_cast<char>(0x80 | (codepoint & 0x3F));
-            }
+        // Render the run before the emoji first
+        if (runStart < glyphStart) {
+            drawList->AddText(ImVec2(cursorX, pos.y), color, runStart, glyphStart);
+            cursorX += ImGui::CalcTextSize(runStart, glyphStart).x;
+        }
+        runStart = textPtr;
+        
+        // Render emoji as image
+        ImVec2 emojiPos(cursorX, pos.y);
+        float emojiHeight = emoji->height * drawScale;
+        if (emojiHeight < lineHeight) {
+            emojiPos.y += (lineHeight - emojiHeight) * 0.5f;
         }
+        queueEmojiQuad(emojiManager, emoji, emojiPos);
+        
+        cursorX += emoji->advance * drawScale;
     }
     
     // Render any remaining text
-    if (!buffer.empty()) {
-        ImVec2 textPos(cursorX, pos.y);
-        drawList->AddText(textPos, color, buffer.c_str());
-        cursorX += ImGui::CalcTextSize(buffer.c_str()).x;
+    if (runStart < textEnd) {
+        drawList->AddText(ImVec2(cursorX, pos.y), color, runStart, textEnd);
+        if (measureEnd) {
+            cursorX += ImGui::CalcTextSize(runStart, textEnd).x;
+        }
+    }
+    
+    flushEmojiQuads(drawList, emojiManager);
+    return cursorX;
+}
+
+static void smartText(const char* text, const char* textEnd) {
+    if (!g_emojiManager) {
+        ImGui::TextUnformatted(text, textEnd);
+        return;
     }
     
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImU32 color = ImGui::GetColorU32(ImGuiCol_Text);
+    float lineHeight = ImGui::GetTextLineHeight();
+    float cursorX = drawSmartText(ImGui::GetWindowDrawList(), text, textEnd, pos, color, g_emojiManager, lineHeight,
+                                  true);
+    
     // Advance cursor
     ImGui::Dummy(ImVec2(cursorX - pos.x, lineHeight));
 }
 
+void SmartText(const char* text) {
+    if (!text) {
+        ImGui::TextUnformatted(text);
+        return;
+    }
+    smartText(text, text + std::strlen(text));
+}
+
 void SmartText(const std::string& text) {
-    SmartText(text.c_str());
+    smartText(text.data(), text.data() + text.size());
 }
 
 void SmartTextWithEmoji(const char* text, const ImVec2& pos, ImU32 color, EmojiManager* emojiManager) {
@@ -129,61 +185,7 @@ void SmartTextWithEmoji(const char* text, const ImVec2& pos, ImU32 color, EmojiM
         return;
     }
     
-    ImDrawList* drawList = ImGui::GetWindowDrawList();
-    const char* textPtr = text;
-    std::string buffer;
-    float cursorX = pos.x;
-    
-    while (*textPtr) {
-        uint32_t codepoint = decodeUTF8(textPtr);
-        const EmojiGlyph* emoji = emojiManager->getEmoji(codepoint);
-        
-        if (emoji) {
-            if (!buffer.empty()) {
-                ImVec2 textPos(cursorX, pos.y);
-                drawList->AddText(textPos, color, buffer.c_str());
-                cursorX += ImGui::CalcTextSize(buffer.c_str()).x;
-                buffer.clear();
-            }
-            
-            ImVec2 emojiPos(cursorX, pos.y);
-            ImVec2 emojiSize(emoji->width, emoji->height);
-            ImVec2 uv0(emoji->u0, emoji->v0);
-            ImVec2 uv1(emoji->u1, emoji->v1);
-            
-            drawList->AddImage(
-                emojiManager->getTextureID(),
-                emojiPos,
-                ImVec2(emojiPos.x + emojiSize.x, emojiPos.y + emojiSize.y),
-                uv0,
-                uv1
-            );
-            
-            cursorX += emoji->advance;
-        } else {
-            // Re-encode to UTF-8
-            if (codepoint < 0x80) {
-                buffer += static_cast<char>(codepoint);
-            } else if (codepoint < 0x800) {
-                buffer += static_cast<char>(0xC0 | (codepoint >> 6));
-                buffer += static_cast<char>(0x80 | (codepoint & 0x3F));
-            } else if (codepoint < 0x10000) {
-                buffer += static_cast<char>(0xE0 | (codepoint >> 12));
-                buffer += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
-                buffer += static_cast<char>(0x80 | (codepoint & 0x3F));
-            } else {
-                buffer += static_cast<char>(0xF0 | (codepoint >> 18));
-                buffer += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
-                buffer += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
-                buffer += static_cast<char>(0x80 | (codepoint & 0x3F));
-            }
-        }
-    }
-    
-    if (!buffer.empty()) {
-        ImVec2 textPos(cursorX, pos.y);
-        drawList->AddText(textPos, color, buffer.c_str());
-    }
+    drawSmartText(ImGui::GetWindowDrawList(), text, text + std::strlen(text), pos, color, emojiManager, 0.0f, false);
 }
 
 } // namespace ImBored::UI
@@ -0,0 +1,192 @@
+#include "ui/svg_glyph_table.hpp"
+#include <iostream>
+#include <algorithm>
+#include <string>
+
+#include <lunasvg.h>
+#include <zlib.h>
+
+namespace ImBored::UI {
+
+namespace {
+
+uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// Find a table in an sfnt (or the first font of a collection)
+bool findTable(const uint8_t* data, size_t size, uint32_t tag, const uint8_t*& table, size_t& tableSize) {
+    size_t base = 0;
+    if (size >= 16 && readU32(data) == 0x74746366) { // 'ttcf'
+        base = readU32(data + 12);
+    }
+    if (base + 12 > size) {
+        return false;
+    }
+    
+    uint16_t numTables = readU16(data + base + 4);
+    if (base + 12 + static_cast<size_t>(numTables) * 16 > size) {
+        return false;
+    }
+    
+    for (uint16_t i = 0; i < numTables; ++i) {
+        const uint8_t* record = data + base + 12 + i * 16;
+        if (readU32(record) != tag) {
+            continue;
+        }
+        
+        size_t offset = readU32(record + 8);
+        size_t length = readU32(record + 12);
+        if (offset + length > size) {
+            return false;
+        }
+        table = data + offset;
+        tableSize = length;
+        return true;
+    }
+    
+    return false;
+}
+
+// Inflate a gzip member; OT-SVG allows gzip-compressed documents
+bool gunzip(const uint8_t* data, size_t size, std::string& out) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        return false;
+    }
+    
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    
+    out.clear();
+    int result = Z_OK;
+    while (result == Z_OK) {
+        size_t written = out.size();
+        out.resize(written + std::max<size_t>(size * 4, 16384));
+        stream.next_out = reinterpret_cast<Bytef*>(&out[written]);
+        stream.avail_out = static_cast<uInt>(out.size() - written);
+        result = inflate(&stream, Z_NO_FLUSH);
+        out.resize(out.size() - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    
+    return result == Z_STREAM_END;
+}
+
+} // namespace
+
+SvgGlyphTable::SvgGlyphTable()
+    : m_documents(nullptr)
+{
+}
+
+bool SvgGlyphTable::load(const uint8_t* fontData, size_t fontDataSize) {
+    m_ranges.clear();
+    m_documents = nullptr;
+    
+    const uint8_t* table;
+    size_t tableSize;
+    if (!findTable(fontData, fontDataSize, 0x53564720, table, tableSize) || tableSize < 10) { // 'SVG '
+        return false;
+    }
+    
+    // Header: version, offset to the document list, reserved
+    size_t listOffset = readU32(table + 2);
+    if (readU16(table) != 0 || listOffset + 2 > tableSize) {
+        std::cerr << "SvgGlyphTable: Unsupported SVG table\n";
+        return false;
+    }
+    
+    const uint8_t* list = table + listOffset;
+    size_t listSize = tableSize - listOffset;
+    uint16_t numEntries = readU16(list);
+    if (2 + static_cast<size_t>(numEntries) * 12 > listSize) {
+        std::cerr << "SvgGlyphTable: Truncated SVG document list\n";
+        return false;
+    }
+    
+    m_ranges.reserve(numEntries);
+    for (uint16_t i = 0; i < numEntries; ++i) {
+        const uint8_t* entry = list + 2 + i * 12;
+        SvgDocumentRange range;
+        range.startGlyph = readU16(entry);
+        range.endGlyph = readU16(entry + 2);
+        range.offset = readU32(entry + 4);
+        range.length = readU32(entry + 8);
+        if (range.endGlyph < range.startGlyph || static_cast<size_t>(range.offset) + range.length > listSize) {
+            continue;
+        }
+        m_ranges.push_back(range);
+    }
+    
+    // The spec requires sorted, non-overlapping ranges; don't rely on it
+    std::sort(m_ranges.begin(), m_ranges.end(),
+              [](const SvgDocumentRange& a, const SvgDocumentRange& b) { return a.startGlyph < b.startGlyph; });
+    
+    m_documents = list;
+    
+    std::cout << "SvgGlyphTable: " << m_ranges.size() << " SVG document ranges\n";
+    return !m_ranges.empty();
+}
+
+const SvgDocumentRange* SvgGlyphTable::find(uint32_t glyphIndex) const {
+    auto it = std::upper_bound(m_ranges.begin(), m_ranges.end(), glyphIndex,
+                               [](uint32_t value, const SvgDocumentRange& range) {
+                                   return value < range.startGlyph;
+                               });
+    if (it == m_ranges.begin() || glyphIndex > (it - 1)->endGlyph) {
+        return nullptr;
+    }
+    return &*(it - 1);
+}
+
+SvgDocumentCache::SvgDocumentCache(const SvgGlyphTable* table)
+    : m_table(table)
+{
+}
+
+SvgDocumentCache::~SvgDocumentCache() {
+}
+
+lunasvg::Document* SvgDocumentCache::getDocument(uint32_t glyphIndex, const SvgDocumentRange** range) {
+    const SvgDocumentRange* found = m_table ? m_table->find(glyphIndex) : nullptr;
+    if (range) {
+        *range = found;
+    }
+    if (!found) {
+        return nullptr;
+    }
+    
+    uint64_t key = (static_cast<uint64_t>(found->offset) << 32) | found->length;
+    auto it = m_documents.find(key);
+    if (it != m_documents.end()) {
+        return it->second.get();
+    }
+    
+    // Parse once; failures are cached too so they aren't retried per glyph
+    const uint8_t* data = m_table->getDocumentData(*found);
+    std::unique_ptr<lunasvg::Document> document;
+    if (found->length >= 2 && data[0] == 0x1F && data[1] == 0x8B) {
+        std::string inflated;
+        if (gunzip(data, found->length, inflated)) {
+            document = lunasvg::Document::loadFromData(inflated.data(), inflated.size());
+        }
+    } else {
+        document = lunasvg::Document::loadFromData(reinterpret_cast<const char*>(data), found->length);
+    }
+    
+    if (!document) {
+        std::cerr << "SvgDocumentCache: Failed to parse SVG document for glyph " << glyphIndex << "\n";
+    }
+    
+    lunasvg::Document* result = document.get();
+    m_documents.emplace(key, std::move(document));
+    return result;
+}
+
+} // namespace ImBored::UI